@@ -15,6 +15,21 @@ bool fileExists(const std::string& fileName);
 
 uint64_t getFileSize(const std::string& fileName);
 
+/** size, modification time and inode (file index on Windows) of a file, tell if the file was changed or replaced */
+struct FileIdentity
+{
+    FileIdentity() : size(0), modTime(0), inode(0) {}
+    bool operator==(const FileIdentity& other) const
+    {
+        return size == other.size && modTime == other.modTime && inode == other.inode;
+    }
+    uint64_t size;
+    int64_t modTime;  // in nanoseconds on unix, in 100 ns units on Windows
+    uint64_t inode;
+};
+
+bool getFileIdentity(const std::string& fileName, FileIdentity& identity);
+
 /** remove file. cerr contains error code */
 bool deleteFile(const std::string& fileName);
 
@@ -29,8 +29,8 @@ class AbstractOutputStream : public AbstractStream
     virtual void sync() = 0;
 };
 
-//! A class which represents an interface for working with files.
-class File : public AbstractOutputStream
+//! An output stream whose cursor can be moved, e.g. to update the headers of a disk image.
+class AbstractSeekableOutputStream : public AbstractOutputStream
 {
    public:
     enum class SeekMethod
@@ -40,6 +40,14 @@ class File : public AbstractOutputStream
         smEnd
     };
 
+    virtual int64_t seek(int64_t offset, SeekMethod whence = SeekMethod::smBegin) const = 0;
+    [[nodiscard]] virtual uint64_t pos() const = 0;
+};
+
+//! A class which represents an interface for working with files.
+class File : public AbstractSeekableOutputStream
+{
+   public:
     File();
     //! Constructor
     /*!
@@ -112,7 +120,7 @@ class File : public AbstractOutputStream
             \param whence
             \return Location of the cursor after relocating it, or uint64_t(-1) in case of an error.
     */
-    int64_t seek(int64_t offset, SeekMethod whence = SeekMethod::smBegin) const;
+    int64_t seek(int64_t offset, SeekMethod whence = SeekMethod::smBegin) const override;
 
     //! Change the size of the file
     /*!
@@ -123,7 +131,7 @@ class File : public AbstractOutputStream
 
     std::string getName() { return m_name; }
 
-    uint64_t pos() const { return m_pos; }
+    uint64_t pos() const override { return m_pos; }
 
    private:
     void* m_impl;
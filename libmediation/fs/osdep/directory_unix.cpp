@@ -34,6 +34,22 @@ uint64_t getFileSize(const std::string& fileName)
     return res ? static_cast<uint64_t>(fileStat.st_size) : 0;
 }
 
+bool getFileIdentity(const std::string& fileName, FileIdentity& identity)
+{
+    struct stat fileStat;
+    if (stat(fileName.c_str(), &fileStat) != 0)
+        return false;
+#if defined(__APPLE__) && defined(__MACH__)
+    const auto& modTime = fileStat.st_mtimespec;
+#else
+    const auto& modTime = fileStat.st_mtim;
+#endif
+    identity.size = static_cast<uint64_t>(fileStat.st_size);
+    identity.modTime = static_cast<int64_t>(modTime.tv_sec) * 1000000000 + modTime.tv_nsec;
+    identity.inode = static_cast<uint64_t>(fileStat.st_ino);
+    return true;
+}
+
 bool createDir(const std::string& dirName, bool createParentDirs)
 {
     auto ok = preCreateDir([](auto) { return false; },
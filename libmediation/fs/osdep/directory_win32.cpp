@@ -35,6 +35,25 @@ uint64_t getFileSize(const std::string& fileName)
     return 0;
 }
 
+bool getFileIdentity(const std::string& fileName, FileIdentity& identity)
+{
+    const HANDLE hFile = CreateFile(toWide(fileName).data(), FILE_READ_ATTRIBUTES,
+                                    FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+                                    FILE_FLAG_BACKUP_SEMANTICS, nullptr);
+    if (hFile == INVALID_HANDLE_VALUE)
+        return false;
+    BY_HANDLE_FILE_INFORMATION info;
+    const bool rez = GetFileInformationByHandle(hFile, &info) != 0;
+    CloseHandle(hFile);
+    if (!rez)
+        return false;
+    identity.size = (static_cast<uint64_t>(info.nFileSizeHigh) << 32) + info.nFileSizeLow;
+    identity.modTime = static_cast<int64_t>((static_cast<uint64_t>(info.ftLastWriteTime.dwHighDateTime) << 32) +
+                                            info.ftLastWriteTime.dwLowDateTime);
+    identity.inode = (static_cast<uint64_t>(info.nFileIndexHigh) << 32) + info.nFileIndexLow;
+    return true;
+}
+
 bool createDir(const std::string& dirName, const bool createParentDirs)
 {
     const bool ok = preCreateDir(
@@ -0,0 +1,37 @@
+#ifndef MIRRORED_BUFFER_H
+#define MIRRORED_BUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+
+//! Ring buffer memory which is mapped twice at adjacent virtual addresses.
+/*!
+    Byte data()[i] and byte data()[i + capacity()] are the same byte, so any range of up to capacity() bytes which
+    starts in the first mapping is contiguous in memory, even if it wraps around the end of the ring.
+*/
+class MirroredBuffer
+{
+   public:
+    MirroredBuffer();
+    ~MirroredBuffer();
+
+    MirroredBuffer(const MirroredBuffer&) = delete;
+    MirroredBuffer& operator=(const MirroredBuffer&) = delete;
+
+    //! Allocate at least minSize bytes. The size is rounded up to the system allocation granularity.
+    /*!
+        \return false if the system can not map the memory twice. The caller should fall back to plain buffers.
+    */
+    bool allocate(size_t minSize);
+    void release();
+
+    [[nodiscard]] uint8_t* data() const { return m_data; }
+    [[nodiscard]] size_t capacity() const { return m_capacity; }
+
+   private:
+    uint8_t* m_data;
+    size_t m_capacity;
+    void* m_handle;  // file mapping object on Windows
+};
+
+#endif  // MIRRORED_BUFFER_H
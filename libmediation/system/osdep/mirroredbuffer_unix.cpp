@@ -0,0 +1,77 @@
+#if !defined(_WIN32)
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <string>
+
+#include "../mirroredbuffer.h"
+
+namespace
+{
+int createSharedMemory(const size_t size)
+{
+#if defined(__linux__) && defined(MFD_CLOEXEC)
+    const int fd = memfd_create("tsmuxer-ring", MFD_CLOEXEC);
+#else
+    static std::atomic<int> counter{0};
+    const std::string name = "/tsmuxer-ring-" + std::to_string(getpid()) + "-" + std::to_string(counter++);
+    const int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd != -1)
+        shm_unlink(name.c_str());
+#endif
+    if (fd == -1)
+        return -1;
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+}  // namespace
+
+MirroredBuffer::MirroredBuffer() : m_data(nullptr), m_capacity(0), m_handle(nullptr) {}
+
+MirroredBuffer::~MirroredBuffer() { release(); }
+
+bool MirroredBuffer::allocate(const size_t minSize)
+{
+    release();
+    const auto pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const size_t size = (minSize + pageSize - 1) / pageSize * pageSize;
+
+    const int fd = createSharedMemory(size);
+    if (fd == -1)
+        return false;
+
+    // reserve the address range for both views, then map the same memory over its halves
+    auto base = static_cast<uint8_t*>(mmap(nullptr, size * 2, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    bool rez = base != MAP_FAILED;
+    if (rez)
+    {
+        rez = mmap(base, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED &&
+              mmap(base + size, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED;
+        if (!rez)
+            munmap(base, size * 2);
+    }
+    close(fd);
+    if (!rez)
+        return false;
+
+    m_data = base;
+    m_capacity = size;
+    return true;
+}
+
+void MirroredBuffer::release()
+{
+    if (m_data)
+        munmap(m_data, m_capacity * 2);
+    m_data = nullptr;
+    m_capacity = 0;
+}
+
+#endif
@@ -0,0 +1,66 @@
+#ifdef _WIN32
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+#include "../mirroredbuffer.h"
+
+static constexpr int MAX_MAP_ATTEMPTS = 16;
+
+MirroredBuffer::MirroredBuffer() : m_data(nullptr), m_capacity(0), m_handle(nullptr) {}
+
+MirroredBuffer::~MirroredBuffer() { release(); }
+
+bool MirroredBuffer::allocate(const size_t minSize)
+{
+    release();
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    const size_t granularity = info.dwAllocationGranularity;
+    const size_t size = (minSize + granularity - 1) / granularity * granularity;
+
+    const uint64_t size64 = size;
+    HANDLE mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                        static_cast<DWORD>(size64 >> 32), static_cast<DWORD>(size64), nullptr);
+    if (mapping == nullptr)
+        return false;
+
+    // find a free address range for both views. Another thread may take it between VirtualFree and MapViewOfFileEx,
+    // so retry a few times
+    for (int i = 0; i < MAX_MAP_ATTEMPTS; ++i)
+    {
+        const auto base = static_cast<uint8_t*>(VirtualAlloc(nullptr, size * 2, MEM_RESERVE, PAGE_NOACCESS));
+        if (base == nullptr)
+            break;
+        VirtualFree(base, 0, MEM_RELEASE);
+
+        void* view1 = MapViewOfFileEx(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size, base);
+        void* view2 = view1 ? MapViewOfFileEx(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size, base + size) : nullptr;
+        if (view1 && view2)
+        {
+            m_data = base;
+            m_capacity = size;
+            m_handle = mapping;
+            return true;
+        }
+        if (view1)
+            UnmapViewOfFile(view1);
+    }
+    CloseHandle(mapping);
+    return false;
+}
+
+void MirroredBuffer::release()
+{
+    if (m_data)
+    {
+        UnmapViewOfFile(m_data);
+        UnmapViewOfFile(m_data + m_capacity);
+        CloseHandle(m_handle);
+    }
+    m_data = nullptr;
+    m_capacity = 0;
+    m_handle = nullptr;
+}
+
+#endif
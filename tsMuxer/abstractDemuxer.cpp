@@ -1,7 +1,114 @@
 #include "abstractDemuxer.h"
+
+#include <algorithm>
+#include <mutex>
+
 #include "subTrackFilter.h"
 
 AbstractDemuxer::~AbstractDemuxer()
 {
     for (const auto &m_pidFilter : m_pidFilters) delete m_pidFilter.second;
 }
+
+DemuxedData::iterator DemuxedData::find(const int32_t pid) const
+{
+    const auto itr = std::lower_bound(m_sorted.begin(), m_sorted.end(), pid,
+                                      [](const value_type* value, const int32_t key) { return value->first < key; });
+    return iterator(itr != m_sorted.end() && (*itr)->first == pid ? itr : m_sorted.end());
+}
+
+DemuxedData::value_type* DemuxedData::insert(const int32_t pid)
+{
+    const auto itr = std::lower_bound(m_sorted.begin(), m_sorted.end(), pid,
+                                      [](const value_type* value, const int32_t key) { return value->first < key; });
+    if (itr != m_sorted.end() && (*itr)->first == pid)
+        return *itr;
+    value_type* value = &m_storage.emplace_back(std::piecewise_construct, std::forward_as_tuple(pid), std::tuple<>());
+    m_sorted.insert(itr, value);
+    if (pid >= 0 && pid < MAX_DIRECT_PID)
+    {
+        if (m_slots.empty())
+            m_slots.resize(MAX_DIRECT_PID);
+        m_slots[pid] = value;
+    }
+    return value;
+}
+
+namespace
+{
+// Free MemoryBlock buffers. Capacities are powers of two, one list per capacity
+class MemoryBlockPool
+{
+   public:
+    static MemoryBlockPool& instance()
+    {
+        static auto pool = new MemoryBlockPool();  // never destroyed: blocks may be released at exit
+        return *pool;
+    }
+
+    uint8_t* acquire(size_t& capacity)
+    {
+        int index = MIN_SIZE_LOG2;
+        while ((static_cast<size_t>(1) << index) < capacity) index++;
+        capacity = static_cast<size_t>(1) << index;
+        {
+            std::lock_guard<std::mutex> lk(m_mtx);
+            std::vector<uint8_t*>& freeList = m_free[index];
+            if (!freeList.empty())
+            {
+                uint8_t* rez = freeList.back();
+                freeList.pop_back();
+                m_cachedBytes -= capacity;
+                return rez;
+            }
+        }
+        return new uint8_t[capacity];
+    }
+
+    void release(uint8_t* data, const size_t capacity)
+    {
+        {
+            std::lock_guard<std::mutex> lk(m_mtx);
+            if (m_cachedBytes + capacity <= MAX_CACHED_BYTES)
+            {
+                int index = MIN_SIZE_LOG2;
+                while ((static_cast<size_t>(1) << index) < capacity) index++;
+                m_free[index].push_back(data);
+                m_cachedBytes += capacity;
+                return;
+            }
+        }
+        delete[] data;
+    }
+
+   private:
+    static constexpr int MIN_SIZE_LOG2 = 8;
+    static constexpr size_t MAX_CACHED_BYTES = 64 * 1024 * 1024;
+
+    MemoryBlockPool() : m_cachedBytes(0) {}
+
+    std::mutex m_mtx;
+    std::vector<uint8_t*> m_free[sizeof(size_t) * 8];
+    size_t m_cachedBytes;
+};
+}  // namespace
+
+MemoryBlock::~MemoryBlock()
+{
+    if (m_data)
+        MemoryBlockPool::instance().release(m_data, m_capacity);
+}
+
+void MemoryBlock::reallocate(size_t capacity)
+{
+    uint8_t* data = MemoryBlockPool::instance().acquire(capacity);
+    if (m_size > 0)
+        memcpy(data, m_data, m_size);
+    if (m_data)
+    {
+        MemoryBlockPool::instance().release(m_data, m_capacity);
+        m_reallocCount++;
+    }
+    m_data = data;
+    m_capacity = capacity;
+}
@@ -3,9 +3,11 @@
 
 #include <assert.h>
 #include <cstring>
+#include <deque>
 #include <map>
 #include <set>
 #include <string>
+#include <vector>
 
 #include <types/types.h>
 
@@ -14,32 +16,39 @@
 
 class SubTrackFilter;
 
+// Growable byte buffer. New memory is not initialised, the capacity grows geometrically and is kept by clear().
+// Buffers of destroyed blocks are returned to a shared pool and reused by the next blocks.
 class MemoryBlock
 {
    public:
-    MemoryBlock(const MemoryBlock& other)
+    MemoryBlock(const MemoryBlock& other) : MemoryBlock() { assert(other.m_size == 0); }
+    MemoryBlock& operator=(const MemoryBlock&) = delete;
+
+    MemoryBlock() : m_data(nullptr), m_capacity(0), m_size(0), m_peakSize(0), m_reallocCount(0) {}
+    ~MemoryBlock();
+
+    void reserve(const size_t num)
     {
-        assert(other.m_size == 0);
-        m_size = 0;
+        if (num > m_capacity)
+            reallocate(num);
     }
 
-    MemoryBlock() : m_size(0) {}
-    void reserve(const unsigned num) { m_data.resize(num); }
-
-    void resize(const unsigned num)
+    void resize(const size_t num)
     {
+        reserve(num);
         m_size = num;
-        if (m_data.size() < m_size)
-            m_data.resize(m_size);
+        if (m_size > m_peakSize)
+            m_peakSize = m_size;
     }
 
     void grow(const size_t num)
     {
-        m_size += num;
-        if (m_data.size() < m_size)
-        {
-            m_data.resize(FFMIN(m_size * 2, m_size + 1024LL * 1024));
-        }
+        const size_t newSize = m_size + num;
+        if (newSize > m_capacity)
+            reallocate(FFMAX(newSize, m_capacity * 2));
+        m_size = newSize;
+        if (m_size > m_peakSize)
+            m_peakSize = m_size;
     }
 
     void append(const uint8_t* data, const size_t num)
@@ -47,26 +56,87 @@ class MemoryBlock
         if (num > 0)
         {
             grow(num);
-            memcpy(&m_data[m_size - num], data, num);
+            memcpy(m_data + m_size - num, data, num);
         }
     }
 
     [[nodiscard]] size_t size() const { return m_size; }
+    [[nodiscard]] size_t capacity() const { return m_capacity; }
 
-    uint8_t* data() { return m_data.empty() ? nullptr : m_data.data(); }
+    uint8_t* data() { return m_data; }
 
     [[nodiscard]] bool isEmpty() const { return m_size == 0; }
 
     void clear() { m_size = 0; }
 
+    [[nodiscard]] size_t getPeakSize() const { return m_peakSize; }
+    [[nodiscard]] uint32_t getReallocCount() const { return m_reallocCount; }
+
    private:
-    std::vector<uint8_t> m_data;
+    void reallocate(size_t capacity);
+
+    uint8_t* m_data;
+    size_t m_capacity;
     size_t m_size;
+    size_t m_peakSize;
+    uint32_t m_reallocCount;
 };
 
 typedef MemoryBlock StreamData;
-typedef std::map<int32_t, StreamData> DemuxedData;
 typedef std::set<int32_t> PIDSet;
+
+// Demuxed data of the accepted PIDs. Replaces std::map<int32_t, StreamData>: the same interface, iteration in PID
+// order, but TS range PIDs are found by direct index and the StreamData address never changes, so readers may keep a
+// pointer to it.
+class DemuxedData
+{
+   public:
+    typedef std::pair<const int32_t, StreamData> value_type;
+
+    class iterator
+    {
+       public:
+        explicit iterator(const std::vector<value_type*>::const_iterator itr) : m_itr(itr) {}
+        value_type& operator*() const { return **m_itr; }
+        value_type* operator->() const { return *m_itr; }
+        iterator& operator++()
+        {
+            ++m_itr;
+            return *this;
+        }
+        bool operator==(const iterator& other) const { return m_itr == other.m_itr; }
+        bool operator!=(const iterator& other) const { return m_itr != other.m_itr; }
+
+       private:
+        std::vector<value_type*>::const_iterator m_itr;
+    };
+
+    DemuxedData() = default;
+    DemuxedData(const DemuxedData&) = delete;
+    DemuxedData& operator=(const DemuxedData&) = delete;
+
+    StreamData& operator[](const int32_t pid)
+    {
+        if (pid >= 0 && pid < MAX_DIRECT_PID && !m_slots.empty() && m_slots[pid])
+            return m_slots[pid]->second;
+        return insert(pid)->second;
+    }
+
+    [[nodiscard]] iterator find(int32_t pid) const;
+    [[nodiscard]] iterator begin() const { return iterator(m_sorted.begin()); }
+    [[nodiscard]] iterator end() const { return iterator(m_sorted.end()); }
+    [[nodiscard]] size_t size() const { return m_sorted.size(); }
+    [[nodiscard]] bool empty() const { return m_sorted.empty(); }
+
+   private:
+    static constexpr int MAX_DIRECT_PID = 0x2000;  // TS PID range
+
+    value_type* insert(int32_t pid);
+
+    std::deque<value_type> m_storage;   // stable addresses
+    std::vector<value_type*> m_sorted;  // ordered by PID
+    std::vector<value_type*> m_slots;   // PID -> data for PIDs below MAX_DIRECT_PID
+};
 // typedef std::map<uint32_t, std::vector<uint8_t> > DemuxedData;
 
 // Used to automatically switch to reading the next file while the current one ends.
@@ -123,6 +193,16 @@ class AbstractDemuxer
     virtual int64_t getTrackDelay(int32_t pid) { return 0; }
     virtual std::vector<AVChapter> getChapters() { return {}; }
     virtual double getTrackFps(uint32_t trackId) { return 0.0; }
+    // Moves the read position to a random access point before time (INTERNAL_PTS_FREQ units) if the container is
+    // indexed. timeOffsets receives the time skipped for each pid. Returns false if the position is unchanged.
+    // The stream readers count the time from their first frame, except the subtitle readers which keep the container
+    // timestamps. A candidate position is used only if every counted track starts at or before the cut after it, and
+    // the latest such position wins. After MAX_SEEK_ATTEMPTS rejected candidates the file is read from the start.
+    static constexpr int MAX_SEEK_ATTEMPTS = 8;
+    virtual bool seekToTime(int64_t time, const PIDSet& pids, std::map<int32_t, int64_t>& timeOffsets)
+    {
+        return false;
+    }
 
     SubTrackFilter* getPidFilter(const int pid)
     {
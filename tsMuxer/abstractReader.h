@@ -35,6 +35,10 @@ class AbstractReader
 
     virtual bool gotoByte(int readerID, int64_t seekDist) = 0;
 
+    // true if every block returned by readBlock directly follows the previous one in memory. Then up to readBuffOffset
+    // bytes from the end of the previous block are already in front of the new block. See BlockCarry
+    virtual bool isContiguous(int readerID) { return false; }
+
    protected:
     uint32_t m_blockSize;
     uint32_t m_allocSize;
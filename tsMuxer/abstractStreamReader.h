@@ -13,6 +13,16 @@
 
 static constexpr int PTS_CONST_OFFSET = 0;
 
+class AbstractStreamReader;
+
+// Notified before a stream reader moves or overwrites the data of the packets it has already returned
+class PacketDataListener
+{
+   public:
+    virtual ~PacketDataListener() = default;
+    virtual void onPacketDataRelease(AbstractStreamReader* reader) = 0;
+};
+
 class AbstractStreamReader : public BaseAbstractStreamReader
 {
    public:
@@ -44,7 +54,8 @@ class AbstractStreamReader : public BaseAbstractStreamReader
           m_streamIndex(0),
           m_tmpBufferLen(0),
           m_demuxMode(false),
-          m_secondary(false)
+          m_secondary(false),
+          m_packetDataListener(nullptr)
     {
     }
 
@@ -61,9 +72,13 @@ class AbstractStreamReader : public BaseAbstractStreamReader
     virtual int getTSDescriptor(uint8_t* dstBuff, bool blurayMode, bool hdmvDescriptors) { return 0; }
     [[nodiscard]] virtual int getStreamHDR() const { return 0; }
     virtual void writePESExtension(PESPacket* pesPacket, const AVPacket& avPacket) {}
+    // Identifies the PES extension writePESExtension produces for the packet. The muxer caches PES headers
+    // per stream and rebuilds them only if this value changes.
+    virtual int getPESExtensionKey(const AVPacket& avPacket) { return 0; }
     virtual void setStreamIndex(const int index) { m_streamIndex = index; }
     [[nodiscard]] int getStreamIndex() const { return m_streamIndex; }
     virtual void setTimeOffset(const int64_t offset) { m_timeOffset = offset; }
+    [[nodiscard]] int64_t getTimeOffset() const { return m_timeOffset; }
     unsigned m_flags;
     virtual const CodecInfo& getCodecInfo() = 0;  // get codecInfo struct. (CodecID, codec name)
     void setSrcContainerType(const ContainerType containerType) { m_containerType = containerType; }
@@ -77,7 +92,21 @@ class AbstractStreamReader : public BaseAbstractStreamReader
     void setPipParams(const PIPParams& params) { m_pipParams = params; }
     [[nodiscard]] PIPParams getPipParams() const { return m_pipParams; }
 
+    // true if packet data stays valid until the listener is notified. Such data may be referenced without copying
+    [[nodiscard]] virtual bool isPacketDataStable() const { return false; }
+    void setPacketDataListener(PacketDataListener* listener) { m_packetDataListener = listener; }
+
    protected:
+    void releasePacketData()
+    {
+        if (m_packetDataListener)
+        {
+            PacketDataListener* listener = m_packetDataListener;
+            m_packetDataListener = nullptr;
+            listener->onPacketDataRelease(this);
+        }
+    }
+
     ContainerType m_containerType;
     int64_t m_timeOffset;
     uint8_t* m_buffer;
@@ -89,6 +118,9 @@ class AbstractStreamReader : public BaseAbstractStreamReader
     bool m_secondary;
 
     PIPParams m_pipParams;
+
+   private:
+    PacketDataListener* m_packetDataListener;
 };
 
 #endif
@@ -15,28 +15,27 @@ bool AC3StreamReader::isPriorityData(AVPacket* packet)
 
 bool AC3StreamReader::isSecondary() { return m_secondary; };
 
+int AC3StreamReader::getPESExtensionKey(const AVPacket& avPacket)
+{
+    if (!m_useNewStyleAudioPES)
+        return 0;
+    if (!m_true_hd_mode || m_downconvertToAC3)
+        return m_bsid > 10 ? 0x72 : 0x71;  // E-AC3 subtype : AC3 subtype
+    if (avPacket.flags & AVPacket::IS_CORE_PACKET)
+        return 0x76;  // AC3 at TRUE-HD
+    return 0x72;  // TRUE-HD data
+}
+
 void AC3StreamReader::writePESExtension(PESPacket* pesPacket, const AVPacket& avPacket)
 {
-    if (m_useNewStyleAudioPES)
+    const int subType = getPESExtensionKey(avPacket);
+    if (subType)
     {
         pesPacket->flagsLo |= 1;  // enable PES extension for AC3 stream
         uint8_t* data = reinterpret_cast<uint8_t*>(pesPacket) + pesPacket->getHeaderLength();
         *data++ = 0x01;
         *data++ = 0x81;
-        if (!m_true_hd_mode || m_downconvertToAC3)
-        {
-            if (m_bsid > 10)
-                *data = 0x72;  // E-AC3 subtype
-            else
-                *data = 0x71;  // AC3 subtype
-        }
-        else
-        {
-            if (avPacket.flags & AVPacket::IS_CORE_PACKET)
-                *data = 0x76;  // AC3 at TRUE-HD
-            else
-                *data = 0x72;  // TRUE-HD data
-        }
+        *data = static_cast<uint8_t>(subType);
         pesPacket->m_pesHeaderLen += 3;
     }
 }
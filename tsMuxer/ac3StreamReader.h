@@ -48,6 +48,7 @@ class AC3StreamReader final : public SimplePacketizerReader, public AC3Codec
     const CodecInfo& getCodecInfo() override { return AC3Codec::getCodecInfo(); }
     const std::string getStreamInfo() override { return AC3Codec::getStreamInfo(); }
     void writePESExtension(PESPacket* pesPacket, const AVPacket& avPacket) override;
+    int getPESExtensionKey(const AVPacket& avPacket) override;
 
     int readPacket(AVPacket& avPacket) override;
     int flushPacket(AVPacket& avPacket) override;
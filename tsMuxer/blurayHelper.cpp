@@ -264,7 +264,7 @@ bool writeBdMovieObjectData(const MuxerManager& muxer, AbstractOutputStream* fil
 
 // ------------------------- BlurayHelper ---------------------------
 
-BlurayHelper::BlurayHelper() : m_dt(), m_isoWriter(nullptr) {}
+BlurayHelper::BlurayHelper() : m_dt(), m_isoWriter(nullptr), m_outputFactory(nullptr) {}
 
 BlurayHelper::~BlurayHelper() { close(); }
 
@@ -288,7 +288,8 @@ bool BlurayHelper::open(const string& dst, const DiskType dt, const int64_t disk
     fileExt = unquoteStr(strToUpperCase(fileExt));
     if (fileExt == "ISO")
     {
-        m_isoWriter = new IsoWriter(useReproducibleIsoHeader ? IsoHeaderData::reproducible() : IsoHeaderData::normal());
+        m_isoWriter = new IsoWriter(useReproducibleIsoHeader ? IsoHeaderData::reproducible() : IsoHeaderData::normal(),
+                                    m_outputFactory ? m_outputFactory->createSeekableFile() : nullptr);
         m_isoWriter->setLayerBreakPoint(0xBA7200);  // around 25Gb
         return m_isoWriter->open(m_dstPath, diskSize, extraISOBlocks);
     }
@@ -298,6 +299,8 @@ bool BlurayHelper::open(const string& dst, const DiskType dt, const int64_t disk
 
 void BlurayHelper::createBluRayDirs() const
 {
+    if (m_outputFactory && !m_isoWriter)
+        return;  // nothing is written to the file system
     if (m_dt == DiskType::BLURAY)
     {
         if (m_isoWriter)
@@ -347,11 +350,7 @@ bool BlurayHelper::writeBluRayFiles(const MuxerManager& muxer, const bool usedBl
 {
     int fileSize = sizeof(bdIndexData);
     const string prefix = m_isoWriter ? "" : m_dstPath;
-    AbstractOutputStream* file;
-    if (m_isoWriter)
-        file = m_isoWriter->createFile();
-    else
-        file = new File();
+    AbstractOutputStream* file = createOutputFile();
 
     if (m_dt == DiskType::BLURAY)
     {
@@ -474,11 +473,7 @@ bool BlurayHelper::createCLPIFile(TSMuxer* muxer, int clpiNum, bool doLog) const
         int fileLen = clpiParser.compose(clpiBuffer, CLPI_BUFFER_SIZE);
 
         string prefix = m_isoWriter ? "" : m_dstPath;
-        AbstractOutputStream* file;
-        if (m_isoWriter)
-            file = m_isoWriter->createFile();
-        else
-            file = new File();
+        AbstractOutputStream* file = createOutputFile();
 
         string dstDir = string("BDMV") + getDirSeparator() + string("CLIPINF") + getDirSeparator();
         string clipName = extractFileName(muxer->getFileNameByIdx(i));
@@ -631,11 +626,7 @@ bool BlurayHelper::createMPLSFile(TSMuxer* mainMuxer, TSMuxer* subMuxer, int aut
     int fileLen = mplsParser.compose(mplsBuffer, bufSize, dt);
 
     string prefix = m_isoWriter ? "" : m_dstPath;
-    AbstractOutputStream* file;
-    if (m_isoWriter)
-        file = m_isoWriter->createFile();
-    else
-        file = new File();
+    AbstractOutputStream* file = createOutputFile();
 
     string dstDir = string("BDMV") + getDirSeparator() + string("PLAYLIST") + getDirSeparator();
     if (!file->open((prefix + dstDir + strPadLeft(int32ToStr(mplsOffset), 5, '0') + string(".mpls")).c_str(),
@@ -694,10 +685,14 @@ string BlurayHelper::ssifFileName(const int num) const
 
 IsoWriter* BlurayHelper::isoWriter() const { return m_isoWriter; }
 
-AbstractOutputStream* BlurayHelper::createFile()
+AbstractOutputStream* BlurayHelper::createFile() { return createOutputFile(); }
+
+AbstractOutputStream* BlurayHelper::createOutputFile() const
 {
     if (m_isoWriter)
         return m_isoWriter->createFile();
+    if (m_outputFactory)
+        return m_outputFactory->createFile();
     return new File();
 }
 
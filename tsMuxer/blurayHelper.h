@@ -12,6 +12,7 @@ struct FileEntryInfo;
 class TSMuxer;
 class AbstractOutputStream;
 class MuxerManager;
+class OutputSinkFactory;
 
 class BlurayHelper final : public FileFactory
 {
@@ -40,11 +41,16 @@ class BlurayHelper final : public FileFactory
     AbstractOutputStream* createFile() override;
     [[nodiscard]] bool isVirtualFS() const override;
     void setVolumeLabel(const std::string& label) const;
+    // create output files, and the ISO image, using the sink instead of the file system. Must be called before open()
+    void setOutputFactory(OutputSinkFactory* factory) { m_outputFactory = factory; }
 
    private:
+    [[nodiscard]] AbstractOutputStream* createOutputFile() const;
+
     std::string m_dstPath;
     DiskType m_dt;
     IsoWriter* m_isoWriter;
+    OutputSinkFactory* m_outputFactory;
 };
 
 #endif  // _BLURAY_HELPER_H_
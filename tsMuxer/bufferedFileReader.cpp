@@ -68,6 +68,13 @@ bool BufferedFileReader::gotoByte(const int readerID, const int64_t seekDist)
     const auto data = dynamic_cast<FileReaderData*>(getReader(readerID));
     if (data)
     {
+        {
+            // a block read ahead from the old position is dropped, a pending read has to finish before the seek
+            std::unique_lock lk(m_readMtx);
+            if (data->m_notified)
+                while (data->m_nextBlockSize == 0 && !data->m_eof) m_readCond.wait(lk);
+            data->m_nextBlockSize = 0;
+        }
         data->m_blockSize = m_blockSize - static_cast<uint32_t>(seekDist % static_cast<uint64_t>(m_blockSize));
         const uint64_t seekRez = data->m_file.seek(seekDist + data->m_fileHeaderSize, File::SeekMethod::smBegin);
         const bool rez = seekRez != static_cast<uint64_t>(-1);
@@ -3,6 +3,9 @@
 
 #include <fs/systemlog.h>
 
+#include <cassert>
+#include <cstring>
+
 #include "abstractReader.h"
 #include "vod_common.h"
 
@@ -16,6 +19,28 @@ int BufferedReader::m_newReaderID = 0;
 std::mutex BufferedReader::m_genReaderMtx;
 static constexpr unsigned QUEUE_MAX_SIZE = 4096;
 
+void BlockCarry::store(const uint8_t* data, const uint32_t len, const bool inPlace)
+{
+    assert(len <= m_maxSize);
+    m_size = len;
+    m_inPlace = inPlace;
+    if (!inPlace && len > 0)
+    {
+        if (m_buffer.empty())
+            m_buffer.resize(m_maxSize);
+        memmove(m_buffer.data(), data, len);
+    }
+}
+
+uint8_t* BlockCarry::restore(uint8_t* data)
+{
+    if (!m_inPlace && m_size > 0)
+        memcpy(data - m_size, m_buffer.data(), m_size);
+    data -= m_size;
+    m_size = 0;
+    return data;
+}
+
 BufferedReader::BufferedReader(const uint32_t blockSize, const uint32_t allocSize, const uint32_t prereadThreshold)
     : m_started(false), m_terminated(false), m_readQueue(QUEUE_MAX_SIZE), m_id(0)
 {
@@ -159,13 +184,22 @@ uint8_t* BufferedReader::readBlock(const int readerID, uint32_t& readCnt, int& r
     }
     readCnt = data->m_nextBlockSize >= 0 ? data->m_nextBlockSize : 0;
     rez = data->m_eof ? DATA_EOF : NO_ERROR;
-    const uint8_t prevIndex = data->m_bufferIndex;
-    data->m_bufferIndex = 1 - data->m_bufferIndex;
+    uint8_t* block = data->nextBlockData() - data->m_readOffset;
+    if (data->isContiguous())
+        data->m_ringPos = static_cast<uint32_t>((data->m_ringPos + readCnt) % data->m_ring.capacity());
+    else
+        data->m_bufferIndex = 1 - data->m_bufferIndex;
     data->m_nextBlockSize = 0;
     data->m_notified = false;
     if (firstBlockVar)
         *firstBlockVar = data->m_firstBlock;
-    return data->m_nextBlock[prevIndex];
+    return block;
+}
+
+bool BufferedReader::isContiguous(const int readerID)
+{
+    const ReaderData* data = getReader(readerID);
+    return data && data->isContiguous();
 }
 
 void BufferedReader::terminate()
@@ -208,7 +242,7 @@ void BufferedReader::thread_main()
             ReaderData* data = getReader(readerID);
             if (data)
             {
-                uint8_t* buffer = data->m_nextBlock[data->m_bufferIndex] + data->m_readOffset;
+                uint8_t* buffer = data->nextBlockData();
                 if (!data->m_deleted)
                 {
                     int bytesReaded = data->readBlock(buffer, data->m_blockSize);
@@ -268,7 +302,9 @@ void BufferedReader::thread_main()
                     {
                         std::lock_guard lk(m_readMtx);
                         data->m_nextBlockSize = bytesReaded;
-                        m_readCond.notify_one();
+                        // several consumers may wait on the condition, e.g. parallel probing, and only one of them
+                        // is waiting for this block
+                        m_readCond.notify_all();
                     }
                 }
 
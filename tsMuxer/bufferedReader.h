@@ -2,10 +2,12 @@
 #define BUFFERED_READER_H_
 
 #include <containers/safequeue.h>
+#include <system/mirroredbuffer.h>
 #include <system/terminatablethread.h>
 
 #include <map>
 #include <string>
+#include <vector>
 
 #include "abstractDemuxer.h"
 #include "abstractReader.h"
@@ -24,7 +26,8 @@ struct ReaderData
           itr(nullptr),
           m_blockSize(0),
           m_allocSize(0),
-          m_readOffset(0)
+          m_readOffset(0),
+          m_ringPos(0)
     {
         m_nextBlock[0] = nullptr;
         m_nextBlock[1] = nullptr;
@@ -47,6 +50,11 @@ virtual void deleteNextBlocks()
 
     virtual void init()
     {
+        // Blocks are placed one after another in the ring, so the end of the previous block is always in front of the
+        // next one and readers do not have to copy it there. Capacity covers the kept data, the block being processed
+        // and the block being preread.
+        if (m_ring.data() || (m_nextBlock[0] == nullptr && m_ring.allocate(m_readOffset + 2ull * m_allocSize)))
+            return;
         // deleteNextBlocks();
         if (m_nextBlock[0] == nullptr)
             m_nextBlock[0] = new uint8_t[m_allocSize];
@@ -60,6 +68,20 @@ virtual void deleteNextBlocks()
         return false;
     }
 
+    // memory for the next block
+    uint8_t* nextBlockData()
+    {
+        if (m_ring.data() == nullptr)
+            return m_nextBlock[m_bufferIndex] + m_readOffset;
+        // use the mirror if the read offset area would start before the ring
+        const uint32_t pos = m_ringPos >= static_cast<uint32_t>(m_readOffset)
+                                 ? m_ringPos
+                                 : m_ringPos + static_cast<uint32_t>(m_ring.capacity());
+        return m_ring.data() + pos;
+    }
+
+    [[nodiscard]] bool isContiguous() const { return m_ring.data() != nullptr; }
+
     virtual int readBlock(uint8_t* buffer, uint32_t max_size) = 0;
 
     virtual bool closeStream() = 0;
@@ -78,6 +100,28 @@ virtual void deleteNextBlocks()
     uint32_t m_allocSize;
     std::string m_streamName;
     int m_readOffset;
+    MirroredBuffer m_ring;
+    uint32_t m_ringPos;  // position of the next block in the ring
+};
+
+// Unprocessed end of a block, which continues in the next block of the same reader. The next block has to be read
+// with a read offset of at least maxSize bytes
+class BlockCarry
+{
+   public:
+    explicit BlockCarry(const uint32_t maxSize) : m_maxSize(maxSize), m_size(0), m_inPlace(false) {}
+
+    // keep the last len bytes of the block. Nothing is copied if the reader is contiguous (inPlace)
+    void store(const uint8_t* data, uint32_t len, bool inPlace);
+    // put the kept bytes in front of the next block. Returns the new block start
+    uint8_t* restore(uint8_t* data);
+    [[nodiscard]] uint32_t size() const { return m_size; }
+
+   private:
+    std::vector<uint8_t> m_buffer;
+    uint32_t m_maxSize;
+    uint32_t m_size;
+    bool m_inPlace;
 };
 
 class BufferedReader : public AbstractReader, TerminatableThread
@@ -97,6 +141,7 @@ class BufferedReader : public AbstractReader, TerminatableThread
     bool seek(int readerID, int64_t offset) override;
     bool incSeek(int readerID, int64_t offset) override;
     bool gotoByte(int readerID, int64_t seekDist) override { return false; }
+    bool isContiguous(int readerID) override;
 
     void setId(const uint32_t value) { m_id = value; }
 
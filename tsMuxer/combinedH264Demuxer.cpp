@@ -114,7 +114,7 @@ void CombinedH264Reader::fillPids(const PIDSet& acceptedPIDs, const int pid)
 // --------------------------------------------- CombinedH264Demuxer ---------------------------
 
 CombinedH264Demuxer::CombinedH264Demuxer(const BufferedReaderManager& readManager, const char* streamName)
-    : m_readManager(readManager)
+    : m_readManager(readManager), m_carry(MAX_TMP_BUFFER_SIZE)
 {
     m_bufferedReader = m_readManager.getReader(streamName);
     m_readerID = m_bufferedReader->createReader(MAX_TMP_BUFFER_SIZE);
@@ -153,7 +153,7 @@ int CombinedH264Demuxer::simpleDemuxBlock(DemuxedData& demuxedData, const PIDSet
         return BufferedFileReader::DATA_NOT_READY;
     }
 
-    if (readedBytes + m_tmpBuffer.size() == 0 || (readedBytes == 0 && m_lastReadRez == BufferedReader::DATA_EOF))
+    if (readedBytes + m_carry.size() == 0 || (readedBytes == 0 && m_lastReadRez == BufferedReader::DATA_EOF))
     {
         m_lastReadRez = readRez;
         return BufferedReader::DATA_EOF;
@@ -163,12 +163,8 @@ int CombinedH264Demuxer::simpleDemuxBlock(DemuxedData& demuxedData, const PIDSet
     m_lastReadRez = readRez;
     data += MAX_TMP_BUFFER_SIZE;
     uint8_t* dataEnd = data + readedBytes;
-    if (m_tmpBuffer.size() > 0)
-    {
-        data -= m_tmpBuffer.size();
-        memcpy(data, m_tmpBuffer.data(), m_tmpBuffer.size());
-        m_tmpBuffer.clear();
-    }
+    data = m_carry.restore(data);
+    const bool contiguous = m_bufferedReader->isContiguous(m_readerID);
     uint8_t* curNal = data;
 
     uint8_t* nextNal = NALUnit::findNALWithStartCode(curNal + 3, dataEnd, true);
@@ -182,7 +178,7 @@ int CombinedH264Demuxer::simpleDemuxBlock(DemuxedData& demuxedData, const PIDSet
             {
                 if (dataEnd - curNal < MAX_TMP_BUFFER_SIZE)
                 {
-                    m_tmpBuffer.append(curNal, dataEnd - curNal);
+                    m_carry.store(curNal, static_cast<uint32_t>(dataEnd - curNal), contiguous);
                     return 0;
                 }
                 // some error in a stream, just ignore
@@ -213,7 +209,7 @@ int CombinedH264Demuxer::simpleDemuxBlock(DemuxedData& demuxedData, const PIDSet
         }
         else
         {
-            m_tmpBuffer.append(curNal, dataEnd - curNal);
+            m_carry.store(curNal, static_cast<uint32_t>(dataEnd - curNal), contiguous);
         }
     }
 
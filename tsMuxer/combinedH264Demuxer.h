@@ -6,6 +6,7 @@
 
 #include "abstractDemuxer.h"
 #include "abstractReader.h"
+#include "bufferedReader.h"
 #include "bufferedReaderManager.h"
 #include "subTrackFilter.h"
 
@@ -35,7 +36,6 @@ class CombinedH264Reader
     bool m_firstDemuxCall;
 
     unsigned m_mvcSPS;
-    MemoryBlock m_tmpBuffer;
     ReadState m_state;
     int m_mvcStreamIndex;
     int m_avcStreamIndex;
@@ -63,6 +63,7 @@ class CombinedH264Demuxer final : public AbstractDemuxer, public CombinedH264Rea
     int m_readerID;
     int m_lastReadRez;
     int64_t m_dataProcessed;
+    BlockCarry m_carry;
 };
 
 class CombinedH264Filter final : public SubTrackFilter, public CombinedH264Reader
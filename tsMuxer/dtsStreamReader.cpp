@@ -121,20 +121,26 @@ int DTSStreamReader::getTSDescriptor(uint8_t* dstBuff, bool blurayMode, const bo
     return 13;  // descriptor length
 }
 
+int DTSStreamReader::getPESExtensionKey(const AVPacket& avPacket)
+{
+    if (!m_useNewStyleAudioPES)
+        return 0;
+    // stream id extension. 71 = DTS frame, 72 HD frame
+    return m_state == DTSDecodeState::stDecodeHD2 || !m_isCoreExists ? 0x72 : 0x71;
+}
+
 void DTSStreamReader::writePESExtension(PESPacket* pesPacket, const AVPacket& avPacket)
 {
     // 0f 81 71 - from blu ray DTS-HD  ( can use 0x01 instead 0x0f. bits 1-3 are reserved.)
     // 0x01 0x81 0x71 - ordinal DTS == 0x71?
-    if (m_useNewStyleAudioPES)
+    const int subType = getPESExtensionKey(avPacket);
+    if (subType)
     {
         pesPacket->flagsLo |= 1;  // enable PES extension for DTS stream
         uint8_t* data = reinterpret_cast<uint8_t*>(pesPacket) + pesPacket->getHeaderLength();
         *data++ = 1;     // PES_extension_flag_2
         *data++ = 0x81;  // marker bit + extension2 len
-        if (m_state == DTSDecodeState::stDecodeHD2 || !m_isCoreExists)
-            *data = 0x72;  // stream id extension. 71 = DTS frame, 72 HD frame
-        else
-            *data = 0x71;  // stream id extension
+        *data = static_cast<uint8_t>(subType);
         pesPacket->m_pesHeaderLen += 3;
     }
 }
@@ -75,6 +75,7 @@ class DTSStreamReader final : public SimplePacketizerReader
     const std::string getStreamInfo() override;
     bool needSkipFrame(const AVPacket& packet) override;
     void writePESExtension(PESPacket* pesPacket, const AVPacket& avPacket) override;
+    int getPESExtensionKey(const AVPacket& avPacket) override;
 
    private:
     DTSHD_SUBTYPE m_hdType;
@@ -2,6 +2,7 @@
 
 #include <types/types.h>
 #include <cmath>
+#include <cstddef>
 
 #include "abstractStreamReader.h"
 #include "vodCoreException.h"
@@ -29,15 +30,65 @@ float av_int2flt(const uint32_t v)
                  static_cast<int>(v >> 23 & 0xFF) - 150);
 }
 
+// ------------------------ MemoryArena ------------------------
+
+static constexpr size_t ARENA_CHUNK_SIZE = 1024 * 1024;
+static constexpr size_t ARENA_ALIGNMENT = alignof(std::max_align_t);
+static constexpr uint64_t MIN_SEEK_SKIP_BLOCKS = 2;  // skip_bytes seeks over at least this many read blocks
+
+MemoryArena::~MemoryArena()
+{
+    for (const auto& chunk : m_chunks) delete[] chunk.data;
+}
+
+uint8_t* MemoryArena::alloc(size_t size)
+{
+    size = (size + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1);
+    while (m_curChunk < m_chunks.size())
+    {
+        Chunk& chunk = m_chunks[m_curChunk];
+        if (m_curPos + size <= chunk.size)
+        {
+            uint8_t* rez = chunk.data + m_curPos;
+            m_curPos += size;
+            return rez;
+        }
+        if (m_curPos == 0)
+        {
+            // unused chunk is too small, replace it
+            delete[] chunk.data;
+            chunk.size = FFMAX(size, ARENA_CHUNK_SIZE);
+            chunk.data = new uint8_t[chunk.size];
+            m_curPos = size;
+            return chunk.data;
+        }
+        m_curChunk++;
+        m_curPos = 0;
+    }
+    const size_t chunkSize = FFMAX(size, ARENA_CHUNK_SIZE);
+    m_chunks.push_back({new uint8_t[chunkSize], chunkSize});
+    m_curPos = size;
+    return m_chunks.back().data;
+}
+
+void MemoryArena::reset()
+{
+    m_curChunk = 0;
+    m_curPos = 0;
+}
+
+// ------------------------ IOContextDemuxer ------------------------
+
 IOContextDemuxer::IOContextDemuxer(const BufferedReaderManager& readManager)
     : tracks(), m_readManager(readManager), m_lastReadRez(0)
 {
     m_lastProcessedBytes = 0;
     m_bufferedReader = m_readManager.getReader("");
-    m_readerID = m_bufferedReader->createReader(TS_FRAME_SIZE);
+    m_readerID = m_bufferedReader->createReader();
     m_curPos = m_bufEnd = nullptr;
     m_processedBytes = 0;
     m_isEOF = false;
+    m_hasFileIterator = false;
     num_tracks = 0;
 }
 
@@ -49,11 +100,12 @@ int IOContextDemuxer::get_byte()
     int readRez = 0;
     if (m_curPos == m_bufEnd)
     {
+        releaseReadBuffer();
         uint8_t* data = m_bufferedReader->readBlock(m_readerID, readedBytes, readRez);  // blocked read mode
         if (readedBytes > 0 && readRez == 0)
             m_bufferedReader->notify(m_readerID, readedBytes);
         m_lastReadRez = readRez;
-        m_curPos = data + 188;
+        m_curPos = data;
         m_bufEnd = m_curPos + readedBytes;
         if (m_curPos == m_bufEnd)
         {
@@ -65,16 +117,108 @@ int IOContextDemuxer::get_byte()
     return *m_curPos++;
 }
 
-uint16_t IOContextDemuxer::get_be16() { return static_cast<uint16_t>(get_byte() << 8 | get_byte()); }
+static inline uint32_t readBE32(const uint8_t* src)
+{
+    return static_cast<uint32_t>(src[0]) << 24 | src[1] << 16 | src[2] << 8 | src[3];
+}
+
+static inline uint64_t readBE64(const uint8_t* src)
+{
+    return static_cast<uint64_t>(readBE32(src)) << 32 | readBE32(src + 4);
+}
+
+// the multi-byte readers take the value from the buffer directly unless it crosses the read block boundary
 
-int IOContextDemuxer::get_be24() { return get_be16() << 8 | get_byte(); }
+uint16_t IOContextDemuxer::get_be16()
+{
+    if (m_bufEnd - m_curPos < 2)
+        return static_cast<uint16_t>(get_byte() << 8 | get_byte());
+    const auto rez = static_cast<uint16_t>(m_curPos[0] << 8 | m_curPos[1]);
+    m_curPos += 2;
+    m_processedBytes += 2;
+    return rez;
+}
+
+int IOContextDemuxer::get_be24()
+{
+    if (m_bufEnd - m_curPos < 3)
+        return get_be16() << 8 | get_byte();
+    const int rez = m_curPos[0] << 16 | m_curPos[1] << 8 | m_curPos[2];
+    m_curPos += 3;
+    m_processedBytes += 3;
+    return rez;
+}
+
+unsigned int IOContextDemuxer::get_be32()
+{
+    if (m_bufEnd - m_curPos < 4)
+        return get_be16() << 16 | get_be16();
+    const uint32_t rez = readBE32(m_curPos);
+    m_curPos += 4;
+    m_processedBytes += 4;
+    return rez;
+}
+
+int64_t IOContextDemuxer::get_be64()
+{
+    if (m_bufEnd - m_curPos < 8)
+        return static_cast<int64_t>(get_be32()) << 32 | get_be32();
+    const auto rez = static_cast<int64_t>(readBE64(m_curPos));
+    m_curPos += 8;
+    m_processedBytes += 8;
+    return rez;
+}
 
-unsigned int IOContextDemuxer::get_be32() { return get_be16() << 16 | get_be16(); }
+void IOContextDemuxer::get_be32_array(uint32_t* dst, size_t count)
+{
+    while (count > 0)
+    {
+        const size_t inBuffer = FFMIN(static_cast<size_t>(m_bufEnd - m_curPos) / 4, count);
+        if (inBuffer == 0)
+        {
+            *dst++ = get_be32();
+            count--;
+            if (m_isEOF)
+                break;
+            continue;
+        }
+        const uint8_t* src = m_curPos;
+        for (size_t i = 0; i < inBuffer; i++) dst[i] = readBE32(src + i * 4);
+        dst += inBuffer;
+        count -= inBuffer;
+        m_curPos += inBuffer * 4;
+        m_processedBytes += static_cast<int64_t>(inBuffer) * 4;
+    }
+    // the values after the end of the file read as 0
+    memset(dst, 0, count * sizeof(uint32_t));
+}
 
-int64_t IOContextDemuxer::get_be64() { return static_cast<int64_t>(get_be32()) << 32 | get_be32(); }
+void IOContextDemuxer::get_be64_array(int64_t* dst, size_t count)
+{
+    while (count > 0)
+    {
+        const size_t inBuffer = FFMIN(static_cast<size_t>(m_bufEnd - m_curPos) / 8, count);
+        if (inBuffer == 0)
+        {
+            *dst++ = get_be64();
+            count--;
+            if (m_isEOF)
+                break;
+            continue;
+        }
+        const uint8_t* src = m_curPos;
+        for (size_t i = 0; i < inBuffer; i++) dst[i] = static_cast<int64_t>(readBE64(src + i * 8));
+        dst += inBuffer;
+        count -= inBuffer;
+        m_curPos += inBuffer * 8;
+        m_processedBytes += static_cast<int64_t>(inBuffer) * 8;
+    }
+    memset(dst, 0, count * sizeof(int64_t));
+}
 
 bool IOContextDemuxer::url_fseek(const int64_t offset)
 {
+    releaseReadBuffer();
     m_curPos = m_bufEnd = nullptr;
     m_isEOF = false;
     m_processedBytes = offset;
@@ -100,11 +244,12 @@ unsigned IOContextDemuxer::get_buffer(uint8_t* binary, unsigned size)
 
     while (dst < dstEnd)
     {
+        releaseReadBuffer();
         uint8_t* data = m_bufferedReader->readBlock(m_readerID, readedBytes, readRez);
         if (readedBytes > 0 && readRez == 0)
             m_bufferedReader->notify(m_readerID, readedBytes);
 
-        m_curPos = data + 188;
+        m_curPos = data;
         m_bufEnd = m_curPos + readedBytes;
         if (readedBytes == 0)
             break;
@@ -133,20 +278,20 @@ void IOContextDemuxer::skip_bytes(const uint64_t size)
         m_curPos += copyLen;
         m_processedBytes += copyLen;
     }
-    /*
-    while (skipLeft > 4LL * m_fileBlockSize)
+    // a long skip seeks over the data instead of reading it. Joined files are read through
+    if (skipLeft > MIN_SEEK_SKIP_BLOCKS * m_readManager.getBlockSize() && !m_hasFileIterator &&
+        dynamic_cast<BufferedFileReader*>(m_bufferedReader))
     {
-        m_bufferedReader->seek(m_readerID, m_fileBlockSize);
-        m_processedBytes += m_fileBlockSize;
-        skipLeft -= m_fileBlockSize;
+        url_fseek(m_processedBytes + static_cast<int64_t>(skipLeft));
+        return;
     }
-    */
     while (skipLeft > 0)
     {
+        releaseReadBuffer();
         uint8_t* data = m_bufferedReader->readBlock(m_readerID, readedBytes, readRez);
         if (readedBytes > 0 && readRez == 0)
             m_bufferedReader->notify(m_readerID, readedBytes);
-        m_curPos = data + 188;
+        m_curPos = data;
         m_bufEnd = m_curPos + readedBytes;
         if (readedBytes == 0)
             break;
@@ -159,6 +304,7 @@ void IOContextDemuxer::skip_bytes(const uint64_t size)
 
 void IOContextDemuxer::setFileIterator(FileNameIterator* itr)
 {
+    m_hasFileIterator = itr != nullptr;
     const auto br = dynamic_cast<BufferedReader*>(m_bufferedReader);
     if (br)
         br->setFileIterator(itr, m_readerID);
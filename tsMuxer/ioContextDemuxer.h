@@ -1,6 +1,7 @@
 #ifndef IO_CONTEXT_DEMUXER_H_
 #define IO_CONTEXT_DEMUXER_H_
 
+#include <new>
 #include <vector>
 
 #include "abstractDemuxer.h"
@@ -12,16 +13,55 @@ static constexpr int TRACKTYPE_PGS = 0x090;
 static constexpr int TRACKTYPE_SRT = 0x190;
 static constexpr int TRACKTYPE_WAV = 0x180;
 
+// Bump allocator for short-lived packets and their data. reset() releases everything at once, the memory chunks are
+// kept for reuse
+class MemoryArena
+{
+   public:
+    MemoryArena() : m_curChunk(0), m_curPos(0) {}
+    ~MemoryArena();
+
+    MemoryArena(const MemoryArena&) = delete;
+    MemoryArena& operator=(const MemoryArena&) = delete;
+
+    uint8_t* alloc(size_t size);
+    template <class T>
+    T* create()
+    {
+        return new (alloc(sizeof(T))) T();
+    }
+    void reset();
+
+   private:
+    struct Chunk
+    {
+        uint8_t* data;
+        size_t size;
+    };
+
+    std::vector<Chunk> m_chunks;
+    size_t m_curChunk;
+    size_t m_curPos;
+};
+
 class ParsedTrackPrivData
 {
    public:
-    ParsedTrackPrivData(uint8_t* buff, int size) {}
-    ParsedTrackPrivData() = default;
+    ParsedTrackPrivData(uint8_t* buff, int size) : m_arena(nullptr) {}
+    ParsedTrackPrivData() : m_arena(nullptr) {}
     virtual ~ParsedTrackPrivData() = default;
 
     virtual void setPrivData(uint8_t* buff, int size) {}
     virtual void extractData(AVPacket* pkt, uint8_t* buff, int size) = 0;
     virtual unsigned newBufferSize(uint8_t* buff, unsigned size) { return 0; }
+
+    // packet data is taken from the arena if it is set, otherwise it is allocated by new[]
+    void setArena(MemoryArena* arena) { m_arena = arena; }
+
+   protected:
+    uint8_t* allocPacketData(const int size) const { return m_arena ? m_arena->alloc(size) : new uint8_t[size]; }
+
+    MemoryArena* m_arena;
 };
 
 enum class IOContextTrackType
@@ -108,6 +148,11 @@ class IOContextDemuxer : public AbstractDemuxer
     bool m_isEOF;
     int64_t m_processedBytes;
     int64_t m_lastProcessedBytes;
+    bool m_hasFileIterator;  // the reader continues with the next file at the end of the current one
+
+    // called before the read buffer is replaced by the next block or by a seek. Data which is referenced in the buffer
+    // must be copied out
+    virtual void releaseReadBuffer() {}
 
     void skip_bytes(uint64_t size);
     unsigned get_buffer(uint8_t* binary, unsigned size);
@@ -117,6 +162,9 @@ class IOContextDemuxer : public AbstractDemuxer
     uint16_t get_be16();
     int get_be24();
     int get_byte();
+    // table readers, count big-endian values are decoded from the read buffer in one pass
+    void get_be32_array(uint32_t* dst, size_t count);
+    void get_be64_array(int64_t* dst, size_t count);
 
     unsigned int get_le16();
     unsigned int get_le24();
@@ -546,7 +546,7 @@ bool ISOFile::open(const char *name, unsigned int oflag, unsigned int systemDepe
     return true;
 }
 
-void ISOFile::sync() { m_owner->m_file.sync(); }
+void ISOFile::sync() { m_owner->m_file->sync(); }
 
 bool ISOFile::close()
 {
@@ -566,10 +566,11 @@ int64_t ISOFile::size() const { return m_entry ? m_entry->m_fileSize : -1; }
 
 // ------------------------------ IsoWriter ----------------------------------
 
-IsoWriter::IsoWriter(const IsoHeaderData &hdrData)
+IsoWriter::IsoWriter(const IsoHeaderData &hdrData, AbstractSeekableOutputStream *file)
     : m_impId(hdrData.impId),
       m_appId(hdrData.appId),
       m_volumeId(hdrData.volumeId),
+      m_file(file ? file : new File()),
       m_buffer{},
       m_currentTime(hdrData.fileTime),
       m_metadataMappingFile(nullptr),
@@ -601,6 +602,7 @@ IsoWriter::~IsoWriter()
     close();
     delete m_rootDirInfo;
     delete m_systemStreamDir;
+    delete m_file;
 }
 
 void IsoWriter::setMetaPartitionSize(const int size) { m_metadataFileLen = roundUp(size, ALLOC_BLOCK_SIZE); }
@@ -615,7 +617,7 @@ void IsoWriter::setVolumeLabel(const std::string &value)
 bool IsoWriter::open(const std::string &fileName, const int64_t diskSize, const int extraISOBlocks)
 {
     constexpr int systemFlags = 0;
-    if (!m_file.open(fileName.c_str(), File::ofWrite, systemFlags))
+    if (!m_file->open(fileName.c_str(), File::ofWrite, systemFlags))
         return false;
 
     if (diskSize > 0)
@@ -627,7 +629,7 @@ bool IsoWriter::open(const std::string &fileName, const int64_t diskSize, const
 
     // 1. write 32K empty space
     memset(m_buffer, 0, sizeof(m_buffer));
-    for (int i = 0; i < 32768 / SECTOR_SIZE; ++i) m_file.write(m_buffer, SECTOR_SIZE);
+    for (int i = 0; i < 32768 / SECTOR_SIZE; ++i) m_file->write(m_buffer, SECTOR_SIZE);
 
     // 2. write Beginning Extended Area Descriptor
     m_buffer[0] = 0;  // Structure Type
@@ -637,7 +639,7 @@ bool IsoWriter::open(const std::string &fileName, const int64_t diskSize, const
     m_buffer[4] = '0';
     m_buffer[5] = '1';
     m_buffer[6] = 1;  // Structure Version
-    m_file.write(m_buffer, SECTOR_SIZE);
+    m_file->write(m_buffer, SECTOR_SIZE);
 
     // 3. Volume recognition structures. NSR Descriptor
     m_buffer[0] = 0;  // Structure Type
@@ -647,7 +649,7 @@ bool IsoWriter::open(const std::string &fileName, const int64_t diskSize, const
     m_buffer[4] = '0';
     m_buffer[5] = '3';
     m_buffer[6] = 1;  // Structure Version
-    m_file.write(m_buffer, SECTOR_SIZE);
+    m_file->write(m_buffer, SECTOR_SIZE);
 
     // 4. Terminating Extended Area Descriptor
     m_buffer[0] = 0;  // Structure Type
@@ -657,23 +659,23 @@ bool IsoWriter::open(const std::string &fileName, const int64_t diskSize, const
     m_buffer[4] = '0';
     m_buffer[5] = '1';
     m_buffer[6] = 1;  // Structure Version
-    m_file.write(m_buffer, SECTOR_SIZE);
+    m_file->write(m_buffer, SECTOR_SIZE);
 
     // 576K align
 
     memset(m_buffer, 0, SECTOR_SIZE);
-    while (m_file.size() < 1024LL * 576) m_file.write(m_buffer, SECTOR_SIZE);
+    while (m_file->size() < 1024LL * 576) m_file->write(m_buffer, SECTOR_SIZE);
 
-    m_partitionStartAddress = static_cast<int>(m_file.size() / SECTOR_SIZE);
+    m_partitionStartAddress = static_cast<int>(m_file->size() / SECTOR_SIZE);
     m_tagLocationBaseAddr = m_partitionStartAddress;
     m_partitionEndAddress = 0;
 
     // Align to 64K (640K total)
     memset(m_buffer, 0, sizeof(m_buffer));
-    for (int i = 0; i < 64 / 2; ++i) m_file.write(m_buffer, SECTOR_SIZE);
+    for (int i = 0; i < 64 / 2; ++i) m_file->write(m_buffer, SECTOR_SIZE);
 
     // -------------- start main volume --------------------------
-    m_metadataLBN = static_cast<int>(m_file.size() / SECTOR_SIZE);
+    m_metadataLBN = static_cast<int>(m_file->size() / SECTOR_SIZE);
 
     // create root
     m_rootDirInfo = new FileEntryInfo(this, nullptr, 0, FileTypes::Directory);
@@ -688,12 +690,12 @@ bool IsoWriter::open(const std::string &fileName, const int64_t diskSize, const
 
     memset(m_buffer, 0, sizeof(m_buffer));
     const int64_t requiredFileSizeLBN = METADATA_START_ADDR + m_metadataFileLen / SECTOR_SIZE;
-    const int64_t currentFileSizeLBN = m_file.size() / SECTOR_SIZE;
-    for (int64_t i = currentFileSizeLBN; i < requiredFileSizeLBN; ++i) m_file.write(m_buffer, SECTOR_SIZE);
+    const int64_t currentFileSizeLBN = m_file->size() / SECTOR_SIZE;
+    for (int64_t i = currentFileSizeLBN; i < requiredFileSizeLBN; ++i) m_file->write(m_buffer, SECTOR_SIZE);
 
     // reserve space for metadata mapping file
 
-    for (int i = 0; i < ALLOC_BLOCK_SIZE / SECTOR_SIZE; ++i) m_file.write(m_buffer, SECTOR_SIZE);
+    for (int i = 0; i < ALLOC_BLOCK_SIZE / SECTOR_SIZE; ++i) m_file->write(m_buffer, SECTOR_SIZE);
 
     m_opened = true;
     return true;
@@ -724,6 +726,16 @@ bool IsoWriter::createDir(const std::string &dir)
 
 ISOFile *IsoWriter::createFile() { return new ISOFile(this); }
 
+int64_t IsoWriter::getFileSize(const std::string &fileName) const
+{
+    const std::vector<std::string> parts = splitStr(toIsoSeparator(fileName).c_str(), '/');
+    const FileEntryInfo *entry = m_rootDirInfo;
+    for (size_t i = 0; entry && i + 1 < parts.size(); ++i) entry = entry->subDirByName(parts[i]);
+    if (entry && !parts.empty())
+        entry = entry->fileByName(*parts.rbegin());
+    return entry ? entry->m_fileSize : -1;
+}
+
 bool IsoWriter::createInterleavedFile(const std::string &inFile1, const std::string &inFile2,
                                       const std::string &outFile)
 {
@@ -801,7 +813,7 @@ FileEntryInfo *IsoWriter::getEntryByName(const std::string &name, const FileType
 
 void IsoWriter::writeMetadata(const int lbn)
 {
-    m_file.seek(static_cast<int64_t>(lbn) * SECTOR_SIZE);
+    m_file->seek(static_cast<int64_t>(lbn) * SECTOR_SIZE);
     m_curMetadataPos = lbn;
     writeFileSetDescriptor();
     writeTerminationDescriptor();
@@ -824,7 +836,7 @@ void IsoWriter::allocateMetadata()
             "parameter in split mode: 4");
 
     // write udf unique id mapping file
-    m_file.seek(static_cast<int64_t>(METADATA_START_ADDR) * SECTOR_SIZE + m_metadataFileLen);
+    m_file->seek(static_cast<int64_t>(METADATA_START_ADDR) * SECTOR_SIZE + m_metadataFileLen);
 
     const auto buffer = new uint8_t[ALLOC_BLOCK_SIZE];
     memset(buffer, 0, ALLOC_BLOCK_SIZE);
@@ -857,30 +869,30 @@ void IsoWriter::close()
         return;
 
     memset(m_buffer, 0, sizeof(m_buffer));
-    while (m_file.size() % ALLOC_BLOCK_SIZE != 1024LL * 62) m_file.write(m_buffer, SECTOR_SIZE);
+    while (m_file->size() % ALLOC_BLOCK_SIZE != 1024LL * 62) m_file->write(m_buffer, SECTOR_SIZE);
 
     // mirror metadata file location and length
-    m_metadataMirrorLBN = static_cast<int>(m_file.size() / SECTOR_SIZE + 1);
+    m_metadataMirrorLBN = static_cast<int>(m_file->size() / SECTOR_SIZE + 1);
     m_tagLocationBaseAddr = m_partitionStartAddress;
     writeExtendedFileEntryDescriptor(false, 0, FileTypes::MetadataMirror, m_metadataFileLen,
                                      m_metadataMirrorLBN - m_partitionStartAddress, 0);
 
     // allocate space for metadata mirror file
     memset(m_buffer, 0, sizeof(m_buffer));
-    for (int i = 0; i < m_metadataFileLen / SECTOR_SIZE; ++i) m_file.write(m_buffer, SECTOR_SIZE);
+    for (int i = 0; i < m_metadataFileLen / SECTOR_SIZE; ++i) m_file->write(m_buffer, SECTOR_SIZE);
 
-    m_partitionEndAddress = static_cast<int>(m_file.size() / SECTOR_SIZE);
+    m_partitionEndAddress = static_cast<int>(m_file->size() / SECTOR_SIZE);
 
     // reserve 64K for EOF anchor volume
     memset(m_buffer, 0, sizeof(m_buffer));
-    for (int i = 0; i < 32; ++i) m_file.write(m_buffer, SECTOR_SIZE);
+    for (int i = 0; i < 32; ++i) m_file->write(m_buffer, SECTOR_SIZE);
 
     allocateMetadata();
 
     m_tagLocationBaseAddr = m_metadataMirrorLBN;
     writeMetadata(m_metadataMirrorLBN);  // write metadata mirror file
 
-    m_file.seek(1024LL * 576);
+    m_file->seek(1024LL * 576);
     // metadata file location and length (located at 576K, point to 640K address)
     m_tagLocationBaseAddr = m_partitionStartAddress;
     writeExtendedFileEntryDescriptor(false, 0, FileTypes::Metadata, m_metadataFileLen,
@@ -896,7 +908,7 @@ void IsoWriter::writeDescriptors()
 {
     m_tagLocationBaseAddr = 0;
     // descriptors in a beginning of a file
-    m_file.seek(1024LL * 64);
+    m_file->seek(1024LL * 64);
 
     writePrimaryVolumeDescriptor();
     writeImpUseDescriptor();
@@ -905,12 +917,12 @@ void IsoWriter::writeDescriptors()
     writeUnallocatedSpaceDescriptor();
     writeTerminationDescriptor();
 
-    m_file.seek(1024LL * 128);
+    m_file->seek(1024LL * 128);
 
     writeLogicalVolumeIntegrityDescriptor();
     writeTerminationDescriptor();
 
-    m_file.seek(1024LL * 512);
+    m_file->seek(1024LL * 512);
 
     writeAnchorVolumeDescriptor(m_partitionEndAddress +
                                 ALLOC_BLOCK_SIZE / SECTOR_SIZE);  // add space for last 64K anchor volume
@@ -918,7 +930,7 @@ void IsoWriter::writeDescriptors()
     // descriptors in a end of a file
 
     const int64_t eofPos = m_partitionEndAddress * static_cast<int64_t>(SECTOR_SIZE);
-    m_file.seek(eofPos + ALLOC_BLOCK_SIZE - SECTOR_SIZE);
+    m_file->seek(eofPos + ALLOC_BLOCK_SIZE - SECTOR_SIZE);
     // TODO: It may be preferable not to include the AVDP at (N - 256) for Rewritable media (ditto DVDFab and ImgBurn)
     writeAnchorVolumeDescriptor(m_partitionEndAddress + ALLOC_BLOCK_SIZE / SECTOR_SIZE);
 
@@ -931,19 +943,19 @@ void IsoWriter::writeDescriptors()
 
     memset(m_buffer, 0, sizeof(m_buffer));
     const int64_t fullFileSize = eofPos + static_cast<int64_t>(1024 * 512) + ALLOC_BLOCK_SIZE;
-    while (m_file.size() < fullFileSize - SECTOR_SIZE) m_file.write(m_buffer, SECTOR_SIZE);
+    while (m_file->size() < fullFileSize - SECTOR_SIZE) m_file->write(m_buffer, SECTOR_SIZE);
     writeAnchorVolumeDescriptor(m_partitionEndAddress + ALLOC_BLOCK_SIZE / SECTOR_SIZE);
 }
 
 int32_t IsoWriter::absoluteSectorNum() const
 {
-    return static_cast<int32_t>(m_file.pos() / SECTOR_SIZE - m_tagLocationBaseAddr);
+    return static_cast<int32_t>(m_file->pos() / SECTOR_SIZE - m_tagLocationBaseAddr);
 }
 
 void IsoWriter::sectorSeek(const Partition partition, const int pos) const
 {
     const int64_t offset = (partition == Partition::MetadataPartition) ? m_curMetadataPos : m_partitionStartAddress;
-    m_file.seek((offset + pos) * SECTOR_SIZE, File::SeekMethod::smBegin);
+    m_file->seek((offset + pos) * SECTOR_SIZE, File::SeekMethod::smBegin);
 }
 
 void IsoWriter::writeEntity(const FileEntryInfo *dir)
@@ -989,7 +1001,7 @@ void IsoWriter::writeAllocationExtentDescriptor(const ExtentList *extents, const
     }
     buff32[5] = static_cast<uint32_t>(curPos - m_buffer - 24);  // length
     calcDescriptorCRC(m_buffer, static_cast<uint16_t>(curPos - m_buffer));
-    m_file.write(m_buffer, SECTOR_SIZE);
+    m_file->write(m_buffer, SECTOR_SIZE);
 }
 
 int IsoWriter::writeExtendedFileEntryDescriptor(const bool namedStream, const uint8_t objectId,
@@ -1058,7 +1070,7 @@ int IsoWriter::writeExtendedFileEntryDescriptor(const bool namedStream, const ui
         buff32[216 / 4] = static_cast<uint32_t>(len);  // Allocation descriptors, data len in bytes
         buff32[220 / 4] = pos;  // Allocation descriptors, start logical block number inside volume
         calcDescriptorCRC(m_buffer, 224);
-        m_file.write(m_buffer, SECTOR_SIZE);
+        m_file->write(m_buffer, SECTOR_SIZE);
         sectorsWrited++;
     }
     else if (extents == nullptr)
@@ -1067,7 +1079,7 @@ int IsoWriter::writeExtendedFileEntryDescriptor(const bool namedStream, const ui
         buff32[212 / 4] = 0x10;  // long AD size
         writeLongAD(m_buffer + 216, static_cast<uint32_t>(len), pos, 0, 0);
         calcDescriptorCRC(m_buffer, 232);
-        m_file.write(m_buffer, SECTOR_SIZE);
+        m_file->write(m_buffer, SECTOR_SIZE);
         sectorsWrited++;
     }
     else
@@ -1089,7 +1101,7 @@ int IsoWriter::writeExtendedFileEntryDescriptor(const bool namedStream, const ui
             curPos += 16;
         }
         calcDescriptorCRC(m_buffer, static_cast<uint16_t>(curPos - m_buffer));
-        m_file.write(m_buffer, SECTOR_SIZE);
+        m_file->write(m_buffer, SECTOR_SIZE);
         sectorsWrited++;
 
         size_t indexStart = indexEnd;
@@ -1156,7 +1168,7 @@ void IsoWriter::writeFileSetDescriptor()
     writer.writeLongAD(0x0800, m_systemStreamLBN, 1, 0);
 
     calcDescriptorCRC(m_buffer, 512);
-    m_file.write(m_buffer, SECTOR_SIZE);
+    m_file->write(m_buffer, SECTOR_SIZE);
 }
 
 void IsoWriter::writePrimaryVolumeDescriptor()
@@ -1212,7 +1224,7 @@ void IsoWriter::writePrimaryVolumeDescriptor()
     // 490..511 Reserved
 
     calcDescriptorCRC(m_buffer, 512);
-    m_file.write(m_buffer, SECTOR_SIZE);
+    m_file->write(m_buffer, SECTOR_SIZE);
 }
 
 void IsoWriter::writeImpUseDescriptor()
@@ -1238,7 +1250,7 @@ void IsoWriter::writeImpUseDescriptor()
     strcpy(reinterpret_cast<char *>(m_buffer) + 0x180, m_appId.c_str());  // ImplementationUse
 
     calcDescriptorCRC(m_buffer, 512);
-    m_file.write(m_buffer, SECTOR_SIZE);
+    m_file->write(m_buffer, SECTOR_SIZE);
 }
 
 void IsoWriter::writePartitionDescriptor()
@@ -1261,7 +1273,7 @@ void IsoWriter::writePartitionDescriptor()
     strcpy(reinterpret_cast<char *>(m_buffer) + 0xe4, m_appId.c_str());  // ImplementationUse
 
     calcDescriptorCRC(m_buffer, 512);
-    m_file.write(m_buffer, SECTOR_SIZE);
+    m_file->write(m_buffer, SECTOR_SIZE);
 }
 
 void IsoWriter::writeLogicalVolumeDescriptor()
@@ -1325,7 +1337,7 @@ void IsoWriter::writeLogicalVolumeDescriptor()
     m_buffer[504] = 0x01;    // Flags
 
     calcDescriptorCRC(m_buffer, 510);
-    m_file.write(m_buffer, SECTOR_SIZE);
+    m_file->write(m_buffer, SECTOR_SIZE);
 }
 
 void IsoWriter::writeUnallocatedSpaceDescriptor()
@@ -1338,7 +1350,7 @@ void IsoWriter::writeUnallocatedSpaceDescriptor()
     buff32[4] = 0x04;  // sequence number
 
     calcDescriptorCRC(m_buffer, 24);
-    m_file.write(m_buffer, SECTOR_SIZE);
+    m_file->write(m_buffer, SECTOR_SIZE);
 }
 
 void IsoWriter::writeTerminationDescriptor()
@@ -1347,7 +1359,7 @@ void IsoWriter::writeTerminationDescriptor()
     writeDescriptorTag(m_buffer, DescriptorTag::Terminating, absoluteSectorNum());
 
     calcDescriptorCRC(m_buffer, 512);
-    m_file.write(m_buffer, SECTOR_SIZE);
+    m_file->write(m_buffer, SECTOR_SIZE);
 }
 
 void IsoWriter::writeLogicalVolumeIntegrityDescriptor()
@@ -1382,7 +1394,7 @@ void IsoWriter::writeLogicalVolumeIntegrityDescriptor()
     strcpy(reinterpret_cast<char *>(m_buffer) + 142, m_appId.c_str());
 
     calcDescriptorCRC(m_buffer, static_cast<uint16_t>(142 + m_appId.size()));
-    m_file.write(m_buffer, SECTOR_SIZE);
+    m_file->write(m_buffer, SECTOR_SIZE);
 }
 
 void IsoWriter::writeAnchorVolumeDescriptor(const uint32_t endPartitionAddr)
@@ -1397,12 +1409,12 @@ void IsoWriter::writeAnchorVolumeDescriptor(const uint32_t endPartitionAddr)
     buff32[7] = endPartitionAddr;  // set size to allocated sectors amount
 
     calcDescriptorCRC(m_buffer, 512);
-    m_file.write(m_buffer, SECTOR_SIZE);
+    m_file->write(m_buffer, SECTOR_SIZE);
 }
 
-void IsoWriter::writeSector(const uint8_t *sectorData) { m_file.write(sectorData, SECTOR_SIZE); }
+void IsoWriter::writeSector(const uint8_t *sectorData) { m_file->write(sectorData, SECTOR_SIZE); }
 
-int IsoWriter::writeRawData(const uint8_t *data, const int size) { return m_file.write(data, size); }
+int IsoWriter::writeRawData(const uint8_t *data, const int size) { return m_file->write(data, size); }
 
 void IsoWriter::checkLayerBreakPoint(const int maxExtentSize)
 {
@@ -1413,7 +1425,7 @@ void IsoWriter::checkLayerBreakPoint(const int maxExtentSize)
         const int size = rest * SECTOR_SIZE;
         const auto tmpBuffer = new uint8_t[size];
         memset(tmpBuffer, 0, size);
-        m_file.write(tmpBuffer, size);
+        m_file->write(tmpBuffer, size);
         delete[] tmpBuffer;
         m_lastWritedObjectID = -1;
     }
@@ -179,7 +179,8 @@ struct IsoHeaderData
 class IsoWriter
 {
    public:
-    IsoWriter(const IsoHeaderData&);
+    // the image is written to file, or to a regular file when it is null. The writer takes the ownership of file
+    IsoWriter(const IsoHeaderData&, AbstractSeekableOutputStream* file = nullptr);
     ~IsoWriter();
 
     void setVolumeLabel(const std::string& value);
@@ -187,6 +188,8 @@ class IsoWriter
 
     bool createDir(const std::string& dir);
     ISOFile* createFile();
+    // size of a file of the image, -1 if it does not exist
+    int64_t getFileSize(const std::string& fileName) const;
 
     bool createInterleavedFile(const std::string& inFile1, const std::string& inFile2, const std::string& outFile);
 
@@ -241,7 +244,7 @@ class IsoWriter
     std::string m_impId;
     std::string m_appId;
     uint32_t m_volumeId;
-    File m_file;
+    AbstractSeekableOutputStream* m_file;
     uint8_t m_buffer[SECTOR_SIZE];
     time_t m_currentTime;
 
@@ -3,6 +3,7 @@
 #include <fs/textfile.h>
 
 #include <iostream>
+#include <memory>
 #include <vector>
 
 #include <cmath>
@@ -13,7 +14,9 @@
 #include "metaDemuxer.h"
 #include "mpegStreamReader.h"
 #include "muxerManager.h"
+#include "outputSink.h"
 #include "pgsStreamReader.h"
+#include "probeCache.h"
 #include "singleFileMuxer.h"
 #include "tsMuxer.h"
 
@@ -23,6 +26,7 @@ BufferedReaderManager readManager(2, DEFAULT_FILE_BLOCK_SIZE, DEFAULT_FILE_BLOCK
                                   DEFAULT_FILE_BLOCK_SIZE / 2);
 TSMuxerFactory tsMuxerFactory;
 SingleFileMuxerFactory singleFileMuxerFactory;
+std::unique_ptr<ProbeCache> probeCache;  // set by --probe-cache
 
 static constexpr char EXCEPTION_ERR_MSG[] =
     ". It does not have to be! Please contact application support team for more information.";
@@ -109,9 +113,8 @@ DiskType checkBluRayMux(const char* metaFileName, int& autoChapterLen, vector<do
     return result;
 }
 
-void detectStreamReader(const char* fileName, MPLSParser* mplsParser, bool isSubMode)
+void printStreamInfo(DetectStreamRez& streamInfo, MPLSParser* mplsParser, bool isSubMode)
 {
-    DetectStreamRez streamInfo = METADemuxer::DetectStreamReader(readManager, fileName, mplsParser == nullptr);
     vector<CheckStreamRez>& streams = streamInfo.streams;
 
     for (unsigned i = 0; i < streams.size(); i++)
@@ -210,6 +213,19 @@ void detectStreamReader(const char* fileName, MPLSParser* mplsParser, bool isSub
         LTRACE(LT_INFO, 2, "");
 }
 
+void detectStreamReader(const char* fileName, MPLSParser* mplsParser, bool isSubMode)
+{
+    DetectStreamRez streamInfo;
+    // playlist clips are detected without duration, only the results of media files are cached
+    if (mplsParser || !probeCache || !probeCache->find(fileName, streamInfo))
+    {
+        streamInfo = METADemuxer::DetectStreamReader(readManager, fileName, mplsParser == nullptr);
+        if (!mplsParser && probeCache)
+            probeCache->store(fileName, streamInfo);
+    }
+    printStreamInfo(streamInfo, mplsParser, isSubMode);
+}
+
 string getBlurayStreamDir(const string& mplsName)
 {
     string dirName = extractFileDir(mplsName);
@@ -230,6 +246,181 @@ string getBlurayStreamDir(const string& mplsName)
     return "";
 }
 
+void detectPlaylist(const char* fileName, const string& fileExt)
+{
+    bool shortExt = fileExt == "mpl";
+    MPLSParser mplsParser;
+    mplsParser.parse(fileName);
+    string streamDir = getBlurayStreamDir(fileName);
+    std::string mediaExt = shortExt ? ".MTS" : ".m2ts";
+    std::string ssifExt = shortExt ? ".SIF" : ".ssif";
+    bool mode3D = mplsParser.isDependStreamExist;
+    bool switchToSsif = false;
+    if (!mplsParser.m_playItems.empty())
+    {
+        MPLSPlayItem& item = mplsParser.m_playItems[0];
+        string itemName = streamDir + item.fileName + mediaExt;
+        if (fileExists(itemName))
+        {
+            if (mode3D && !mplsParser.m_mvcFiles.empty())
+            {
+                string subItemName = streamDir + mplsParser.m_mvcFiles[0] + mediaExt;
+                if (fileExists(subItemName))
+                    detectStreamReader(subItemName.c_str(), &mplsParser, true);
+                else
+                    switchToSsif = true;
+            }
+        }
+        else
+        {
+            switchToSsif = true;
+        }
+        if (switchToSsif)
+        {
+            string ssifName = streamDir + string("SSIF") + getDirSeparator() + item.fileName + ssifExt;
+            if (fileExists(ssifName))
+                itemName = ssifName;  // if m2ts file absent then swith to ssif
+        }
+        detectStreamReader(itemName.c_str(), &mplsParser, false);
+    }
+
+    size_t markIndex = 0;
+    int64_t prevFileOffset = 0;
+    for (size_t i = 0; i < mplsParser.m_playItems.size(); i++)
+    {
+        MPLSPlayItem& item = mplsParser.m_playItems[i];
+
+        string itemName;
+        if (mode3D)
+            itemName = streamDir + string("SSIF") + getDirSeparator() + item.fileName + ".ssif";
+        else
+            itemName = streamDir.append(item.fileName).append(mediaExt);  // 2d mode
+
+        LTRACE(LT_INFO, 2, "");
+        LTRACE(LT_INFO, 2, "File #" << strPadLeft(int64ToStr(i), 5, '0') << " name=" << itemName);
+        LTRACE(LT_INFO, 2,
+               "Duration: " << floatToTime((mplsParser.m_playItems[i].OUT_time - mplsParser.m_playItems[i].IN_time) /
+                                           (double)45000.0));
+        if (mplsParser.isDependStreamExist)
+        {
+            if (mplsParser.mvc_base_view_r)
+            {
+                LTRACE(LT_INFO, 2, "Base view: right-eye");
+            }
+            else
+            {
+                LTRACE(LT_INFO, 2, "Base view: left-eye");
+            }
+        }
+        if (!mplsParser.m_playItems.empty())
+            LTRACE(LT_INFO, 2, "start-time: " << mplsParser.m_playItems[0].IN_time);
+        int marksPerFile = 0;
+        for (; markIndex < mplsParser.m_marks.size(); markIndex++)
+        {
+            PlayListMark& curMark = mplsParser.m_marks[markIndex];
+            if (static_cast<unsigned>(curMark.m_playItemID) > i)
+                break;
+            uint64_t time = curMark.m_markTime - mplsParser.m_playItems[i].IN_time + prevFileOffset;
+            if (marksPerFile % 5 == 0)
+            {
+                if (marksPerFile > 0)
+                    LTRACE(LT_INFO, 2, "");
+                LTRACE2(LT_INFO, "Marks: ")
+            }
+            marksPerFile++;
+            LTRACE2(LT_INFO, floatToTime((double)time / 45000.0) << " ")
+        }
+        if (marksPerFile > 0)
+            LTRACE(LT_INFO, 2, "");
+        prevFileOffset += mplsParser.m_playItems[i].OUT_time - mplsParser.m_playItems[i].IN_time;
+    }
+}
+
+void printProbeError(const std::exception_ptr& error)
+{
+    try
+    {
+        std::rethrow_exception(error);
+    }
+    catch (runtime_error& e)
+    {
+        LTRACE(LT_INFO, 2, "Error: " << e.what());
+    }
+    catch (VodCoreException& e)
+    {
+        LTRACE(LT_INFO, 2, "Error: " << e.m_errStr);
+    }
+    catch (BitStreamException& e)
+    {
+        LTRACE(LT_INFO, 2, "Error: Bitstream exception " << e.what());
+    }
+    catch (...)
+    {
+        LTRACE(LT_INFO, 2, "Error: Unknnown exception");
+    }
+}
+
+// probes several files, the media files in parallel. The output of each file follows an "Input file:" line, and
+// ends with an "Error:" line if it can't be probed. Returns false if a file can't be probed
+bool detectStreamReaders(int fileCnt, char** fileNames)
+{
+    vector<DetectStreamRez> mediaInfo;
+    vector<string> probedFiles;
+    vector<size_t> probedIndex;
+    for (int i = 0; i < fileCnt; i++)
+    {
+        const string fileExt = strToLowerCase(extractFileExt(fileNames[i]));
+        if (fileExt == "mpls" || fileExt == "mpl")
+            continue;
+        mediaInfo.emplace_back();
+        if (!probeCache || !probeCache->find(fileNames[i], mediaInfo.back()))
+        {
+            probedFiles.emplace_back(fileNames[i]);
+            probedIndex.push_back(mediaInfo.size() - 1);
+        }
+    }
+    vector<DetectStreamRez> probedInfo = METADemuxer::DetectStreamReaders(readManager, probedFiles, true);
+    for (size_t i = 0; i < probedFiles.size(); i++)
+    {
+        if (probeCache)
+            probeCache->store(probedFiles[i], probedInfo[i]);
+        mediaInfo[probedIndex[i]] = probedInfo[i];
+    }
+
+    bool probed = true;
+    auto mediaItr = mediaInfo.begin();
+    for (int i = 0; i < fileCnt; i++)
+    {
+        LTRACE(LT_INFO, 2, "");
+        LTRACE(LT_INFO, 2, "Input file: " << fileNames[i]);
+        try
+        {
+            const string fileExt = strToLowerCase(extractFileExt(fileNames[i]));
+            if (fileExt == "mpls" || fileExt == "mpl")
+                detectPlaylist(fileNames[i], fileExt);
+            else
+            {
+                DetectStreamRez& streamInfo = *mediaItr++;
+                cerr << streamInfo.warnings;
+                cout << streamInfo.messages;
+                if (streamInfo.error)
+                {
+                    printProbeError(streamInfo.error);
+                    probed = false;
+                }
+                else
+                    printStreamInfo(streamInfo, nullptr, false);
+            }
+        }
+        catch (...)
+        {
+            printProbeError(std::current_exception());
+            probed = false;
+        }
+    }
+    return probed;
+}
+
 void muxBlankPL(const string& appDir, BlurayHelper& blurayHelper, const PIDListMap& pidList, DiskType dt, int blankNum)
 {
     unsigned videoWidth = 1920;
@@ -305,6 +496,48 @@ void muxBlankPL(const string& appDir, BlurayHelper& blurayHelper, const PIDListM
     deleteFile(tmpFileName);
 }
 
+void showDryRunStats(const OutputSinkFactory& sinkFactory, const MuxerManager& muxerManager,
+                     BlurayHelper& blurayHelper)
+{
+    LTRACE(LT_INFO, 2, "");
+    LTRACE(LT_INFO, 2, "Output sink results:");
+    set<string> processedFiles;
+    for (const auto muxer : {muxerManager.getMainMuxer(), muxerManager.getSubMuxer()})
+    {
+        const auto tsMuxer = dynamic_cast<TSMuxer*>(muxer);
+        if (!tsMuxer)
+            continue;
+        const vector<int64_t> firstPts = tsMuxer->getFirstPts();
+        const vector<int64_t> lastPts = tsMuxer->getLastPts();
+        for (size_t i = 0; i < tsMuxer->splitFileCnt(); ++i)
+        {
+            const string fileName = tsMuxer->getFileNameByIdx(i);
+            if (!processedFiles.insert(fileName).second)
+                continue;  // ssif file is shared by both muxers
+            const IsoWriter* isoWriter = blurayHelper.isoWriter();
+            const int64_t fileSize =
+                isoWriter ? isoWriter->getFileSize(fileName) : sinkFactory.getFileSize(fileName);
+            const double duration = static_cast<double>(lastPts[i] - firstPts[i]) / 90000.0;
+            const double start = static_cast<double>(firstPts[i] - firstPts[0]) / 90000.0;
+            LTRACE(LT_INFO, 2,
+                   fileName << ": " << fileSize << " bytes, start " << floatToTime(start) << ", duration "
+                            << floatToTime(duration) << ", average bitrate "
+                            << (duration > 0 ? llround(static_cast<double>(fileSize) * 8 / duration / 1000.0) : 0)
+                            << " kbps");
+        }
+    }
+    blurayHelper.close();  // the ISO image is stored in the sink once it is finalized
+    int64_t totalSize = 0;
+    const map<string, int64_t> fileSizes = sinkFactory.getFileSizes();
+    for (const auto& [fileName, fileSize] : fileSizes)
+    {
+        totalSize += fileSize;
+        if (sinkFactory.getType() == OutputSinkType::Hash)
+            LTRACE(LT_INFO, 2, fileName << ": CRC32 " << int32uToHex(sinkFactory.getFileHash(fileName)));
+    }
+    LTRACE(LT_INFO, 2, "Total size: " << totalSize << " bytes in " << fileSizes.size() << " file(s)");
+}
+
 void doTruncatedFile(const char* fileName, const int64_t offset)
 {
     File f;
@@ -333,12 +566,20 @@ tsMuxeR does not use external filters (codecs).
 
 Examples:
     tsMuxeR <media file name>
+    tsMuxeR --probe <media file name> [<media file name> ...]
+    tsMuxeR --probe-cache=<cache file> <media file name>
     tsMuxeR <meta file name> <out file/dir name>
 
 tsMuxeR can be run in track detection mode or muxing mode. If tsMuxeR is run
 with only one argument, then the program displays track information required to
-construct a meta file. When running with two arguments, tsMuxeR starts the
-muxing or demuxing process.
+construct a meta file. With --probe, several files are detected in parallel and
+the information of each file follows an "Input file: <name>" line, in the order
+of the arguments. A file which can't be probed ends with an "Error: <message>"
+line and the exit code is then not 0. Detection can be preceded by
+--probe-cache=<file>: the results are then stored in this file and reused for
+files whose size, modification time and inode are unchanged, along with those
+of the CLIPINF file of a Blu-ray stream. When running with two arguments,
+tsMuxeR starts the muxing or demuxing process.
 
 Meta file format:
 File MUST have the .meta extension and be encoded in UTF-8 (but see README.md).
@@ -494,6 +735,20 @@ All parameters in this group start with two dashes:
                       together with --cbr. The parameter is similar to  the value
                       of vbv-buffer-size  in  the  x264  codec,  but  defined in
                       milliseconds instead of kbit.
+--tstd-report         Simulate the T-STD buffer model while muxing and report the
+                      bitrate and elementary buffer fill of every PID per second,
+                      buffer underflows and overflows. The report is written to
+                      the log or to the file given as --tstd-report=<file>.
+--dry-run             Run the full muxing process without writing the output.
+                      Prints the size, duration and average bitrate of every
+                      output file, so it can be used to predict the result of
+                      --split-size and --split-duration. An ISO image is built
+                      in the sink too. Not available for demuxing.
+--output-sink         Same as --dry-run, but the output is sent to the given
+                      sink: discard (same as --dry-run), memory (the output is
+                      kept in RAM) or hash (CRC32 of every output file is
+                      printed, an ISO image is kept in RAM until it is hashed).
+                      Used to measure the muxing speed without disk I/O.
 --no-asyncio          Do not  create  a separate thread  for writing. This option
                       also disables the FILE_FLAG_NO_BUFFERING flag on Windows
                       when writing.
@@ -519,7 +774,8 @@ All parameters in this group start with two dashes:
 --avchd               Mux to AVCHD disc.
 --cut-start           Trim the beginning of the file. The value should be followed
                       by the time unit : "ms" (milliseconds), "s" (seconds) or
-                      "min" (minutes).
+                      "min" (minutes). Indexed Matroska and MP4/MOV files, and
+                      TS/M2TS files, are read from the keyframe before the cut.
 --cut-end             Trim the end of the file. Same rules as --cut-start apply.
 --split-duration      Split the output into several files, with each of them being
                       <n> seconds long.
@@ -590,106 +846,39 @@ int main(int argc, char** argv)
 
     try
     {
-        if (argc == 2)
+        int firstArg = 1;
+        if (argc > 1 && strStartWith(argv[1], "--probe-cache="))
+        {
+            probeCache = std::make_unique<ProbeCache>(string(argv[1]).substr(strlen("--probe-cache=")));
+            firstArg++;
+        }
+        if (argc > firstArg + 1 && string(argv[firstArg]) == "--probe")
+        {
+            const bool probed = detectStreamReaders(argc - firstArg - 1, argv + firstArg + 1);
+            if (probeCache)
+                probeCache->save();
+            cout << endl;
+            return probed ? 0 : -1;
+        }
+        if (argc == firstArg + 1)
         {
-            string str = argv[1];
+            string str = argv[firstArg];
             string fileExt = extractFileExt(str);
             fileExt = strToLowerCase(fileExt);
             if (fileExt == "mpls" || fileExt == "mpl")
-            {
-                bool shortExt = fileExt == "mpl";
-                MPLSParser mplsParser;
-                mplsParser.parse(argv[1]);
-                string streamDir = getBlurayStreamDir(argv[1]);
-                std::string mediaExt = shortExt ? ".MTS" : ".m2ts";
-                std::string ssifExt = shortExt ? ".SIF" : ".ssif";
-                bool mode3D = mplsParser.isDependStreamExist;
-                bool switchToSsif = false;
-                if (!mplsParser.m_playItems.empty())
-                {
-                    MPLSPlayItem& item = mplsParser.m_playItems[0];
-                    string itemName = streamDir + item.fileName + mediaExt;
-                    if (fileExists(itemName))
-                    {
-                        if (mode3D && !mplsParser.m_mvcFiles.empty())
-                        {
-                            string subItemName = streamDir + mplsParser.m_mvcFiles[0] + mediaExt;
-                            if (fileExists(subItemName))
-                                detectStreamReader(subItemName.c_str(), &mplsParser, true);
-                            else
-                                switchToSsif = true;
-                        }
-                    }
-                    else
-                    {
-                        switchToSsif = true;
-                    }
-                    if (switchToSsif)
-                    {
-                        string ssifName = streamDir + string("SSIF") + getDirSeparator() + item.fileName + ssifExt;
-                        if (fileExists(ssifName))
-                            itemName = ssifName;  // if m2ts file absent then swith to ssif
-                    }
-                    detectStreamReader(itemName.c_str(), &mplsParser, false);
-                }
-
-                size_t markIndex = 0;
-                int64_t prevFileOffset = 0;
-                for (size_t i = 0; i < mplsParser.m_playItems.size(); i++)
-                {
-                    MPLSPlayItem& item = mplsParser.m_playItems[i];
-
-                    string itemName;
-                    if (mode3D)
-                        itemName = streamDir + string("SSIF") + getDirSeparator() + item.fileName + ".ssif";
-                    else
-                        itemName = streamDir.append(item.fileName).append(mediaExt);  // 2d mode
-
-                    LTRACE(LT_INFO, 2, "");
-                    LTRACE(LT_INFO, 2, "File #" << strPadLeft(int64ToStr(i), 5, '0') << " name=" << itemName);
-                    LTRACE(LT_INFO, 2,
-                           "Duration: " << floatToTime(
-                               (mplsParser.m_playItems[i].OUT_time - mplsParser.m_playItems[i].IN_time) /
-                               (double)45000.0));
-                    if (mplsParser.isDependStreamExist)
-                    {
-                        if (mplsParser.mvc_base_view_r)
-                        {
-                            LTRACE(LT_INFO, 2, "Base view: right-eye");
-                        }
-                        else
-                        {
-                            LTRACE(LT_INFO, 2, "Base view: left-eye");
-                        }
-                    }
-                    if (!mplsParser.m_playItems.empty())
-                        LTRACE(LT_INFO, 2, "start-time: " << mplsParser.m_playItems[0].IN_time);
-                    int marksPerFile = 0;
-                    for (; markIndex < mplsParser.m_marks.size(); markIndex++)
-                    {
-                        PlayListMark& curMark = mplsParser.m_marks[markIndex];
-                        if (static_cast<unsigned>(curMark.m_playItemID) > i)
-                            break;
-                        uint64_t time = curMark.m_markTime - mplsParser.m_playItems[i].IN_time + prevFileOffset;
-                        if (marksPerFile % 5 == 0)
-                        {
-                            if (marksPerFile > 0)
-                                LTRACE(LT_INFO, 2, "");
-                            LTRACE2(LT_INFO, "Marks: ")
-                        }
-                        marksPerFile++;
-                        LTRACE2(LT_INFO, floatToTime((double)time / 45000.0) << " ")
-                    }
-                    if (marksPerFile > 0)
-                        LTRACE(LT_INFO, 2, "");
-                    prevFileOffset += mplsParser.m_playItems[i].OUT_time - mplsParser.m_playItems[i].IN_time;
-                }
-            }
+                detectPlaylist(argv[firstArg], fileExt);
             else
-                detectStreamReader(argv[1], nullptr, false);
+                detectStreamReader(argv[firstArg], nullptr, false);
+            if (probeCache)
+                probeCache->save();
             cout << endl;
             return 0;
         }
+        if (probeCache)
+        {
+            LTRACE(LT_ERROR, 2, "--probe-cache can only be used for track detection");
+            return -1;
+        }
         if (argc != 3)
         {
             /*
@@ -719,10 +908,14 @@ int main(int argc, char** argv)
         if (muxMode)
         {
             BlurayHelper blurayHelper;
+            OutputSinkFactory sinkFactory;
 
             MuxerManager muxerManager(readManager, tsMuxerFactory);
             muxerManager.setAllowStereoMux(fileExt2 == "SSIF" || dt != DiskType::NONE);
             muxerManager.openMetaFile(argv[1]);
+            sinkFactory.setType(muxerManager.getOutputSink());
+            if (muxerManager.getOutputSink() != OutputSinkType::None)
+                blurayHelper.setOutputFactory(&sinkFactory);
             if (!isV3() && dt == DiskType::BLURAY && muxerManager.getHevcFound())
             {
                 LTRACE(LT_INFO, 2, "HEVC stream detected: changing Blu-Ray version to V3.");
@@ -746,7 +939,12 @@ int main(int argc, char** argv)
             }
             if (muxerManager.getTrackCnt() == 0)
                 THROW(ERR_COMMON, "No tracks selected")
-            muxerManager.doMux(dstFile, dt != DiskType::NONE ? &blurayHelper : nullptr);
+            FileFactory* fileFactory = nullptr;
+            if (dt != DiskType::NONE)
+                fileFactory = &blurayHelper;
+            else if (muxerManager.getOutputSink() != OutputSinkType::None)
+                fileFactory = &sinkFactory;
+            muxerManager.doMux(dstFile, fileFactory);
             if (dt != DiskType::NONE)
             {
                 blurayHelper.writeBluRayFiles(muxerManager, insertBlankPL, firstMplsOffset, blankNum, stereoMode);
@@ -789,12 +987,18 @@ int main(int argc, char** argv)
                 }
             }
 
+            if (muxerManager.getOutputSink() != OutputSinkType::None)
+                showDryRunStats(sinkFactory, muxerManager, blurayHelper);
+
             LTRACE(LT_INFO, 2, "Mux successful complete");
         }
         else
         {
             MuxerManager sMuxer(readManager, singleFileMuxerFactory);
             sMuxer.openMetaFile(argv[1]);
+            // the demuxed files are written by SingleFileMuxer directly, without a FileFactory
+            if (sMuxer.getOutputSink() != OutputSinkType::None)
+                THROW(ERR_COMMON, "--dry-run and --output-sink can't be used to demux")
             if (sMuxer.getTrackCnt() == 0)
                 THROW(ERR_COMMON, "No tracks selected")
 
@@ -8,6 +8,7 @@
 
 #include "abstractDemuxer.h"
 #include "avPacket.h"
+#include "bufferedFileReader.h"
 #include "subTrackFilter.h"
 #include "vodCoreException.h"
 
@@ -25,6 +26,9 @@ static constexpr int AVERROR_INVALIDDATA = -1;
 
 static constexpr int COMPRESSION_STRIP_HEADERS = 3;
 static constexpr int COMPRESSION_ZLIB = 0;
+static constexpr size_t MIN_INFLATE_BUFFER_SIZE = 4096;
+static constexpr size_t MAX_INFLATE_SIZE = 32 * 1024 * 1024;
+static constexpr int MAX_SCANNED_CLUSTERS = 16;  // clusters searched for the first block of each track
 
 #define AV_RL32(x) ((x)[3] << 24 | (x)[2] << 16 | (x)[1] << 8 | (x)[0])
 
@@ -187,10 +191,219 @@ int MatroskaDemuxer::matroska_parse_index()
     return res;
 }
 
+int64_t MatroskaDemuxer::findCuesPosition()
+{
+    uint32_t id;
+    int64_t length;
+    if (m_seekHeadPos == -1 || ebml_read_seek(m_seekHeadPos) < 0 || ebml_read_element_id(&id, nullptr) < 0 ||
+        ebml_read_element_length(&length) < 0)
+        return -1;
+    const int64_t seekHeadEnd = m_processedBytes + length;
+    while (m_processedBytes < seekHeadEnd)
+    {
+        if ((id = ebml_peek_id(nullptr)) == 0)
+            return -1;
+        if (id != MATROSKA_ID_SEEKENTRY)
+        {
+            if (ebml_read_skip() < 0)
+                return -1;
+            continue;
+        }
+        if (ebml_read_element_length(&length) < 0)
+            return -1;
+        const int64_t entryEnd = m_processedBytes + length;
+        uint32_t seekId = 0;
+        int64_t seekPos = -1;
+        while (m_processedBytes < entryEnd)
+        {
+            int res;
+            switch (ebml_peek_id(nullptr))
+            {
+            case 0:
+                return -1;
+            case MATROSKA_ID_SEEKID:
+            {
+                uint8_t *data;
+                int size;
+                if ((res = ebml_read_binary(&id, &data, &size)) == 0)
+                {
+                    for (int i = 0; i < size; i++) seekId = seekId << 8 | data[i];
+                    delete[] data;
+                }
+                break;
+            }
+            case MATROSKA_ID_SEEKPOSITION:
+                res = ebml_read_uint(&id, &seekPos);
+                break;
+            default:
+                res = ebml_read_skip();
+            }
+            if (res < 0)
+                return -1;
+        }
+        if (seekId == MATROSKA_ID_CUES && seekPos >= 0)
+            return static_cast<int64_t>(segment_start) + seekPos;
+    }
+    return -1;
+}
+
+// Reads the cluster at pos up to the first block of each track. Returns the position after the cluster or -1.
+int64_t MatroskaDemuxer::scanClusterTimecodes(const int64_t pos, std::map<int, int64_t> &firstTimecodes)
+{
+    uint32_t id;
+    int64_t length;
+    if (ebml_read_seek(pos) < 0 || ebml_read_element_id(&id, nullptr) < 0 || id != MATROSKA_ID_CLUSTER)
+        return -1;
+    int read = ebml_read_element_length(&length);
+    if (read < 0 || length == (1LL << (7 * read)) - 1)
+        return -1;  // unknown size
+    const int64_t clusterEnd = m_processedBytes + length;
+    int64_t clusterTime = 0;
+    while (m_processedBytes < clusterEnd)
+    {
+        if (ebml_read_element_id(&id, nullptr) < 0 || (read = ebml_read_element_length(&length)) < 0 ||
+            length == (1LL << (7 * read)) - 1)
+            return -1;
+        if (id == MATROSKA_ID_BLOCKGROUP)
+            continue;  // the block is the next child element
+        const int64_t elementEnd = m_processedBytes + length;
+        if (id == MATROSKA_ID_CLUSTERTIMECODE && length >= 1 && length <= 8)
+        {
+            clusterTime = 0;
+            for (int i = 0; i < length; i++) clusterTime = clusterTime << 8 | get_byte();
+        }
+        else if ((id == MATROSKA_ID_SIMPLEBLOCK || id == MATROSKA_ID_BLOCK) && length >= 4)
+        {
+            int64_t num;
+            if (ebml_read_num(8, &num) < 0)
+                return -1;
+            const auto blockTime = static_cast<int16_t>(get_be16());
+            const int track = matroska_find_track_by_num(num);
+            if (track >= 0 && firstTimecodes.find(track) == firstTimecodes.end())
+                firstTimecodes[track] = clusterTime + blockTime;
+        }
+        if (m_processedBytes > elementEnd)
+            return -1;
+        skip_bytes(elementEnd - m_processedBytes);
+    }
+    return m_isEOF ? -1 : clusterEnd;
+}
+
+void MatroskaDemuxer::restartAtCluster(const int64_t pos)
+{
+    ebml_read_seek(pos);
+    num_levels = m_clusterLevels;
+    level_up = 0;
+    m_inCluster = false;
+    m_blockInPlace = false;
+    done = false;
+}
+
+bool MatroskaDemuxer::seekToTime(const int64_t time, const PIDSet &pids, std::map<int32_t, int64_t> &timeOffsets)
+{
+    if (m_firstClusterPos == -1 || m_lastProcessedBytes != 0 || !packets.empty() || !m_pidFilters.empty() ||
+        !dynamic_cast<BufferedFileReader *>(m_bufferedReader))
+        return false;
+
+    // the subtitle tracks are timed by their block timecodes
+    std::vector<int> countedTracks;
+    for (const int pid : pids)
+    {
+        if (pid < 1 || pid > num_tracks)
+            return false;
+        if (tracks[pid - 1]->type != IOContextTrackType::SUBTITLE)
+            countedTracks.push_back(pid - 1);
+    }
+    const int64_t cutTime = time * 1000 / INTERNAL_PTS_FREQ;
+
+    int64_t clusterPos = -1;
+    std::map<int, int64_t> firstTimecodes;
+    std::map<int, int64_t> seekTimecodes;
+    try
+    {
+        if (indexes.empty())
+        {
+            const int64_t cuesPos = findCuesPosition();
+            if (cuesPos != -1 && ebml_read_seek(cuesPos) == 0 && ebml_peek_id(nullptr) == MATROSKA_ID_CUES)
+            {
+                uint32_t id;
+                num_levels = m_clusterLevels;
+                if (ebml_read_master(&id) == 0)
+                    matroska_parse_index();
+            }
+        }
+
+        auto hasAllTracks = [&countedTracks](const std::map<int, int64_t> &timecodes) {
+            return std::all_of(countedTracks.begin(), countedTracks.end(),
+                               [&timecodes](const int track) { return timecodes.count(track) > 0; });
+        };
+        int64_t pos = m_firstClusterPos;
+        for (int i = 0; i < MAX_SCANNED_CLUSTERS && pos != -1 && !hasAllTracks(firstTimecodes); i++)
+            pos = scanClusterTimecodes(pos, firstTimecodes);
+
+        if (!indexes.empty() && hasAllTracks(firstTimecodes))
+        {
+            std::vector<MatroskaDemuxIndex> cues = indexes;
+            std::stable_sort(cues.begin(), cues.end(), [](const MatroskaDemuxIndex &a, const MatroskaDemuxIndex &b) {
+                return a.time < b.time;
+            });
+            // the candidates are the cue points, each is checked by scanning the block timecodes of its cluster
+            int attempts = 0;
+            for (auto itr = cues.rbegin(); itr != cues.rend() && attempts < MAX_SEEK_ATTEMPTS; ++itr)
+            {
+                const int track = matroska_find_track_by_num(itr->track);
+                const int64_t firstTime = firstTimecodes.count(track) ? firstTimecodes[track] : 0;
+                if (static_cast<int64_t>(itr->time / time_scale) - firstTime > cutTime ||
+                    static_cast<int64_t>(itr->pos) <= m_firstClusterPos)
+                    continue;
+                attempts++;
+                seekTimecodes.clear();
+                if (scanClusterTimecodes(static_cast<int64_t>(itr->pos), seekTimecodes) == -1 ||
+                    !hasAllTracks(seekTimecodes))
+                    continue;
+                if (std::all_of(countedTracks.begin(), countedTracks.end(), [&](const int t) {
+                        return seekTimecodes[t] >= firstTimecodes[t] && seekTimecodes[t] - firstTimecodes[t] <= cutTime;
+                    }))
+                {
+                    clusterPos = static_cast<int64_t>(itr->pos);
+                    break;
+                }
+            }
+        }
+    }
+    catch (VodCoreException &e)
+    {
+        LTRACE(LT_WARN, 0, "Matroska seek failed: " << e.m_errStr);
+        clusterPos = -1;
+    }
+
+    if (clusterPos == -1)
+    {
+        restartAtCluster(m_firstClusterPos);
+        return false;
+    }
+
+    for (const int pid : pids) timeOffsets[pid] = 0;
+    for (const int track : countedTracks)
+    {
+        timeOffsets[track + 1] = (seekTimecodes[track] - firstTimecodes[track]) * INTERNAL_PTS_FREQ / 1000;
+        m_firstTimecode[tracks[track]->num] = firstTimecodes[track];
+    }
+    restartAtCluster(clusterPos);
+    return true;
+}
+
 MatroskaDemuxer::MatroskaDemuxer(const BufferedReaderManager &readManager)
-    : IOContextDemuxer(readManager), levels(), m_title(), created(0), fileDuration(0)
+    : IOContextDemuxer(readManager), levels(), m_title(), created(0), fileDuration(0), m_inflateContexts()
 {
-    m_lastDeliveryPacket = nullptr;
+    m_blockData = nullptr;
+    m_blockSize = 0;
+    m_blockInPlace = false;
+    m_clusterTime = 0;
+    m_inCluster = false;
+    m_firstClusterPos = -1;
+    m_clusterLevels = 0;
+    m_seekHeadPos = -1;
     num_levels = 0;
     level_up = 0;
     peek_id = 0;
@@ -454,29 +667,40 @@ int MatroskaDemuxer::ebml_read_sint(uint32_t *id, int64_t *num)
     return 0;
 }
 
-void MatroskaDemuxer::decompressData(uint8_t *data, const int size)
+void MatroskaDemuxer::decompressData(const int track, const uint8_t *data, const int size)
 {
-    z_stream zstream = {};
+    m_tmpBuffer.clear();
 
-    int err = inflateInit(&zstream);
-    if (err != Z_OK)
+    // the inflate context of the track is created once and reset for every block
+    z_stream *&zstream = m_inflateContexts[track];
+    if (zstream == nullptr)
+    {
+        zstream = new z_stream();
+        if (inflateInit(zstream) != Z_OK)
+        {
+            delete zstream;
+            zstream = nullptr;
+            return;
+        }
+    }
+    else if (inflateReset(zstream) != Z_OK)
         return;
 
-    zstream.avail_in = size;
-    zstream.next_in = data;
-    int curSize = size;
+    zstream->next_in = const_cast<uint8_t *>(data);
+    zstream->avail_in = size;
+    m_tmpBuffer.reserve(FFMAX(static_cast<size_t>(size) * 3, MIN_INFLATE_BUFFER_SIZE));
+    int err;
     do
     {
-        curSize *= 3;
-        m_tmpBuffer.resize(curSize);
+        // inflate straight into the free space of the buffer, the capacity grows geometrically
+        if (m_tmpBuffer.size() == m_tmpBuffer.capacity())
+            m_tmpBuffer.reserve(m_tmpBuffer.capacity() * 2);
+        zstream->next_out = m_tmpBuffer.data() + m_tmpBuffer.size();
+        zstream->avail_out = static_cast<unsigned>(m_tmpBuffer.capacity() - m_tmpBuffer.size());
+        err = inflate(zstream, Z_NO_FLUSH);
+        m_tmpBuffer.resize(zstream->total_out);
+    } while (err == Z_OK && m_tmpBuffer.size() < MAX_INFLATE_SIZE);
 
-        zstream.avail_out = static_cast<unsigned>(m_tmpBuffer.size() - zstream.total_out);
-        zstream.next_out = m_tmpBuffer.data() + zstream.total_out;
-        err = inflate(&zstream, Z_NO_FLUSH);
-    } while (err == Z_OK && curSize < 10000000);
-
-    m_tmpBuffer.resize(zstream.total_out);
-    inflateEnd(&zstream);
     if (err != Z_STREAM_END)
         m_tmpBuffer.clear();
 }
@@ -486,8 +710,6 @@ int MatroskaDemuxer::matroska_parse_block(uint8_t *data, int size, const int64_t
 {
     int res = 0;
     // AVStream *st;
-    const uint8_t *origdata = data;
-    int *lace_size = nullptr;
     int n, laces = 0;
     uint64_t num;
 
@@ -495,7 +717,6 @@ int MatroskaDemuxer::matroska_parse_block(uint8_t *data, int size, const int64_t
     if ((n = matroska_ebmlnum_uint(data, size, &num)) < 0)
     {
         LTRACE(LT_ERROR, 0, "EBML block data error");
-        delete[] origdata;
         return res;
     }
     data += n;
@@ -507,7 +728,6 @@ int MatroskaDemuxer::matroska_parse_block(uint8_t *data, int size, const int64_t
     if (size <= 3 || track < 0 || track >= num_tracks)
     {
         LTRACE(LT_INFO, 0, "Invalid stream " << track << " or size " << size);
-        delete[] origdata;
         return res;
     }
     if (tracks[track]->stream_index < 0)
@@ -524,8 +744,7 @@ int MatroskaDemuxer::matroska_parse_block(uint8_t *data, int size, const int64_t
     {
     case 0x0: /* no lacing */
         laces = 1;
-        lace_size = reinterpret_cast<int32_t *>(new uint8_t[sizeof(int)]);
-        lace_size[0] = size;
+        m_laceSizes.assign(1, size);
         break;
 
     // see https://www.matroska.org/technical/notes.html
@@ -542,8 +761,7 @@ int MatroskaDemuxer::matroska_parse_block(uint8_t *data, int size, const int64_t
         laces = (*data) + 1;
         data += 1;
         size -= 1;
-        lace_size = reinterpret_cast<int32_t *>(new uint8_t[laces * sizeof(int)]);
-        memset(lace_size, 0, static_cast<size_t>(laces) * sizeof(int));
+        m_laceSizes.assign(laces, 0);
 
         switch ((flags & 0x06) >> 1)
         {
@@ -560,13 +778,13 @@ int MatroskaDemuxer::matroska_parse_block(uint8_t *data, int size, const int64_t
                         break;
                     }
                     const uint8_t temp = *data;
-                    lace_size[n] += temp;
+                    m_laceSizes[n] += temp;
                     data += 1;
                     size -= 1;
                     if (temp != 0xff)
                         break;
                 }
-                total += lace_size[n];
+                total += m_laceSizes[n];
             }
             if (total > size)
             {
@@ -577,12 +795,12 @@ int MatroskaDemuxer::matroska_parse_block(uint8_t *data, int size, const int64_t
             // if more  than one frame in the lace,
             // size of last frame is remaining size
             if (laces > 1)
-                lace_size[n] = size - total;
+                m_laceSizes[n] = size - total;
             break;
         }
 
         case 0x2: /* fixed-size lacing */
-            for (n = 0; n < laces; n++) lace_size[n] = size / laces;
+            for (n = 0; n < laces; n++) m_laceSizes[n] = size / laces;
             break;
 
         case 0x3: /* EBML lacing */
@@ -595,7 +813,7 @@ int MatroskaDemuxer::matroska_parse_block(uint8_t *data, int size, const int64_t
             }
             data += n;
             size -= n;
-            int32_t total = lace_size[0] = static_cast<int32_t>(num);
+            int32_t total = m_laceSizes[0] = static_cast<int32_t>(num);
 
             for (n = 1; res == 0 && n < laces - 1; n++)
             {
@@ -608,18 +826,18 @@ int MatroskaDemuxer::matroska_parse_block(uint8_t *data, int size, const int64_t
                 data += r;
                 size -= r;
 
-                lace_size[n] = lace_size[n - 1] + static_cast<int32_t>(snum);
-                total += lace_size[n];
+                m_laceSizes[n] = m_laceSizes[n - 1] + static_cast<int32_t>(snum);
+                total += m_laceSizes[n];
             }
             // if more  than one frame in the lace,
             // size of last frame is remaining size
             if (laces > 1)
-                lace_size[n] = size - total;
+                m_laceSizes[n] = size - total;
 
             // check that all read frame sizes are > 0
             for (n = 0; res == 0 && n < laces; n++)
             {
-                if (lace_size[n] < 0)
+                if (m_laceSizes[n] < 0)
                 {
                     LTRACE(LT_INFO, 0, "EBML block data error");
                     break;
@@ -653,7 +871,7 @@ int MatroskaDemuxer::matroska_parse_block(uint8_t *data, int size, const int64_t
             {
                 slices = *data++ + 1;
                 size--;
-                lace_size[n]--;
+                m_laceSizes[n]--;
             }
 
             for (int slice = 0; slice < slices; slice++)
@@ -662,63 +880,63 @@ int MatroskaDemuxer::matroska_parse_block(uint8_t *data, int size, const int64_t
                 if (real_v)
                     slice_offset = rv_offset(data, slice, slices);
                 if (slice + 1 == slices)
-                    slice_size = lace_size[n] - slice_offset;
+                    slice_size = m_laceSizes[n] - slice_offset;
                 else
                     slice_size = rv_offset(data, slice + 1, slices) - slice_offset;
 
-                auto *pkt = new AVPacket();
-                pkt->data = nullptr;
-                pkt->size = 0;
+                auto *pkt = m_packetArena.create<AVPacket>();
                 pkt->pts = timecode * INTERNAL_PTS_FREQ / 1000;
                 pkt->pos = pos;
                 pkt->duration = duration * INTERNAL_PTS_FREQ / 1000;
 
                 pkt->stream_index = track + 1;  // tracks[track]->stream_index;
 
-                int offset = 0;
-                uint8_t *curPtr = data + slice_offset;
-                int curPtr_size = size - slice_offset;
-                m_tmpBuffer.clear();
-                if (tracks[track]->encodingAlgo == COMPRESSION_STRIP_HEADERS)
+                if (slice_size < 0 || slice_offset < 0 || size - slice_offset < slice_size)
                 {
-                    offset = static_cast<int>(tracks[track]->encodingAlgoPriv.size());
-                    if (offset)
-                    {
-                        curPtr -= offset;
-                        curPtr_size += offset;
-                        m_tmpBuffer.append(curPtr, offset);  // save data
-                        memcpy(curPtr, tracks[track]->encodingAlgoPriv.data(),
-                               offset);  // place extra header direct to data
-                    }
+                    LTRACE(LT_ERROR, 0, "invalid slice size");
+                    return res;
                 }
-                else if (tracks[track]->encodingAlgo == COMPRESSION_ZLIB)
+
+                // the frame is referenced in the block data unless it has to be rebuilt
+                uint8_t *curPtr = data + slice_offset;
+                int curSize = slice_size;
+                bool inBlock = true;
+                const std::vector<uint8_t> &strippedHeader = tracks[track]->encodingAlgoPriv;
+                if (tracks[track]->encodingAlgo == COMPRESSION_STRIP_HEADERS && !strippedHeader.empty())
                 {
-                    decompressData(curPtr, slice_size);
+                    m_tmpBuffer.clear();
+                    m_tmpBuffer.append(strippedHeader.data(), strippedHeader.size());
+                    m_tmpBuffer.append(curPtr, slice_size);
                     curPtr = m_tmpBuffer.data();
-                    curPtr_size = slice_size = static_cast<int>(m_tmpBuffer.size());
+                    curSize = static_cast<int>(m_tmpBuffer.size());
+                    inBlock = false;
                 }
-
-                if (curPtr_size < 0 || slice_size + offset < 0 || curPtr_size < slice_size + offset)
+                else if (tracks[track]->encodingAlgo == COMPRESSION_ZLIB)
                 {
-                    LTRACE(LT_ERROR, 0, "invalid slice size");
-                    delete[] origdata;
-                    delete[] lace_size;
-                    return res;
+                    decompressData(track, curPtr, slice_size);
+                    curPtr = m_tmpBuffer.data();
+                    curSize = static_cast<int>(m_tmpBuffer.size());
+                    inBlock = false;
                 }
 
                 if (tracks[track]->parsed_priv_data != nullptr)
                 {
-                    tracks[track]->parsed_priv_data->extractData(pkt, curPtr, slice_size + offset);
+                    tracks[track]->parsed_priv_data->extractData(pkt, curPtr, curSize);
                 }
-                else if (slice_size + offset > 0)
+                else if (curSize > 0)
                 {
-                    pkt->data = new uint8_t[slice_size + offset];
-                    pkt->size = slice_size + offset;
-                    // TODO : check compiler warning 'Reading invalid data from curPtr'
-                    memcpy(pkt->data, curPtr, slice_size + offset);
+                    pkt->size = curSize;
+                    if (inBlock && m_blockInPlace)
+                    {
+                        pkt->data = curPtr;
+                        m_inPlacePackets.push_back(pkt);
+                    }
+                    else
+                    {
+                        pkt->data = m_packetArena.alloc(curSize);
+                        memcpy(pkt->data, curPtr, curSize);
+                    }
                 }
-                if (offset)
-                    memcpy(curPtr, m_tmpBuffer.data(), offset);  // restore data
 
                 if (n == 0)
                     pkt->flags = is_keyframe;
@@ -728,17 +946,15 @@ int MatroskaDemuxer::matroska_parse_block(uint8_t *data, int size, const int64_t
                 if (timecode != AV_NOPTS_VALUE)
                     timecode = duration ? timecode + duration : AV_NOPTS_VALUE;
             }
-            data += lace_size[n];
-            size -= lace_size[n];
+            data += m_laceSizes[n];
+            size -= m_laceSizes[n];
         }
     }
 
-    delete[] lace_size;
-    delete[] origdata;
     return res;
 }
 
-int MatroskaDemuxer::matroska_parse_blockgroup(const int64_t cluster_time)
+int MatroskaDemuxer::matroska_parse_blockgroup()
 {
     int res = 0;
     uint32_t id;
@@ -746,8 +962,7 @@ int MatroskaDemuxer::matroska_parse_blockgroup(const int64_t cluster_time)
     int is_keyframe = PKT_FLAG_KEY;
     const size_t last_num_packets = packets.size();
     int64_t duration = AV_NOPTS_VALUE;
-    uint8_t *data = nullptr;
-    int size = 0;
+    bool blockFound = false;
     int64_t pos = 0;
 
     while (res == 0)
@@ -771,7 +986,8 @@ int MatroskaDemuxer::matroska_parse_blockgroup(const int64_t cluster_time)
         case MATROSKA_ID_BLOCK:
         {
             pos = m_processedBytes;
-            res = ebml_read_binary(&id, &data, &size);
+            res = ebml_read_block(&id);
+            blockFound = true;
             break;
         }
 
@@ -817,8 +1033,9 @@ int MatroskaDemuxer::matroska_parse_blockgroup(const int64_t cluster_time)
     if (res)
         return res;
 
-    if (data != nullptr)
-        res = matroska_parse_block(data, size, pos, cluster_time, duration, is_keyframe, is_bframe);
+    if (blockFound)
+        res = matroska_parse_block(m_blockData, m_blockSize, pos, m_clusterTime, duration, is_keyframe, is_bframe);
+    m_blockInPlace = false;
 
     return res;
 }
@@ -945,17 +1162,67 @@ int MatroskaDemuxer::ebml_read_binary(uint32_t *id, uint8_t **binary, int *size)
     return 0;
 }
 
+int MatroskaDemuxer::ebml_read_block(uint32_t *id)
+{
+    int64_t rlength;
+    int res;
+
+    if ((res = ebml_read_element_id(id, nullptr)) < 0 || (res = ebml_read_element_length(&rlength)) < 0)
+        return res;
+    const auto size = static_cast<int>(rlength);
+    if (size < 0)
+        THROW(ERR_MATROSKA_PARSE, "Matroska parser: invalid element size at pos " << m_processedBytes)
+    m_blockSize = size;
+    if (m_bufEnd - m_curPos >= size)
+    {
+        // the whole block is in the read buffer, reference it in place
+        m_blockData = m_curPos;
+        m_blockInPlace = true;
+        m_curPos += size;
+        m_processedBytes += size;
+        return 0;
+    }
+    m_blockBuffer.resize(size);
+    m_blockData = m_blockBuffer.data();
+    m_blockInPlace = false;
+    if (static_cast<int>(get_buffer(m_blockData, size)) != size)
+    {
+        THROW(ERR_MATROSKA_PARSE, "Matroska parser: read error at pos " << m_processedBytes)
+    }
+    return 0;
+}
+
+void MatroskaDemuxer::releaseReadBuffer()
+{
+    for (AVPacket *pkt : m_inPlacePackets)
+    {
+        uint8_t *data = m_packetArena.alloc(pkt->size);
+        memcpy(data, pkt->data, pkt->size);
+        pkt->data = data;
+    }
+    m_inPlacePackets.clear();
+    if (m_blockInPlace)
+    {
+        m_blockBuffer.resize(m_blockSize);
+        memcpy(m_blockBuffer.data(), m_blockData, m_blockSize);
+        m_blockData = m_blockBuffer.data();
+        m_blockInPlace = false;
+    }
+}
+
 int MatroskaDemuxer::matroska_parse_cluster()
 {
     int res = 0;
     uint32_t id;
-    int64_t cluster_time = 0;
-    uint8_t *data;
     int64_t pos;
-    int size;
 
     while (res == 0)
     {
+        // deliver the packets before the block they may reference leaves the read buffer. Parsing resumes on the
+        // next readPacket() call
+        if (!packets.empty())
+            return 0;
+
         if ((id = ebml_peek_id(&level_up)) == 0)
         {
             res = -BufferedReader::DATA_EOF;
@@ -975,7 +1242,7 @@ int MatroskaDemuxer::matroska_parse_cluster()
             int64_t num;
             if ((res = ebml_read_uint(&id, &num)) < 0)
                 break;
-            cluster_time = num;
+            m_clusterTime = num;
             break;
         }
 
@@ -983,14 +1250,15 @@ int MatroskaDemuxer::matroska_parse_cluster()
         case MATROSKA_ID_BLOCKGROUP:
             if ((res = ebml_read_master(&id)) < 0)
                 break;
-            res = matroska_parse_blockgroup(cluster_time);
+            res = matroska_parse_blockgroup();
             break;
 
         case MATROSKA_ID_SIMPLEBLOCK:
             pos = m_processedBytes;
-            res = ebml_read_binary(&id, &data, &size);
+            res = ebml_read_block(&id);
             if (res == 0)
-                res = matroska_parse_block(data, size, pos, cluster_time, AV_NOPTS_VALUE, -1, 0);
+                res = matroska_parse_block(m_blockData, m_blockSize, pos, m_clusterTime, AV_NOPTS_VALUE, -1, 0);
+            m_blockInPlace = false;
             break;
 
         case EBML_ID_VOID:
@@ -1000,6 +1268,7 @@ int MatroskaDemuxer::matroska_parse_cluster()
         // Don't know why here is the next cluster without level up. Probably file error
         // TODO: does the EBML need to be skipped ?
         case MATROSKA_ID_CLUSTER:
+            m_inCluster = false;
             return 0;
         default:
             LTRACE(LT_WARN, 0, "Unknown entry " << id << " in cluster data");
@@ -1013,6 +1282,7 @@ int MatroskaDemuxer::matroska_parse_cluster()
         }
     }
 
+    m_inCluster = false;
     return res;
 }
 
@@ -1048,6 +1318,11 @@ void MatroskaDemuxer::openFile(const std::string &streamName)
     m_processedBytes = 0;
     m_isEOF = false;
 
+    m_blockInPlace = false;
+    m_inCluster = false;
+    m_firstClusterPos = -1;
+    m_clusterLevels = 0;
+    m_seekHeadPos = -1;
     num_levels = 0;
     level_up = 0;
     peek_id = 0;
@@ -1070,14 +1345,19 @@ void MatroskaDemuxer::readClose()
 {
     delete[] writing_app;
     delete[] muxing_app;
-    while (!packets.empty())
+    while (!packets.empty()) packets.pop();
+    m_inPlacePackets.clear();
+    m_packetArena.reset();
+    for (int i = 0; i < num_tracks; i++) delete[] reinterpret_cast<char *>(tracks[i]);
+    for (auto &zstream : m_inflateContexts)
     {
-        const AVPacket *pkt = packets.front();
-        delete[] pkt->data;
-        delete pkt;
-        packets.pop();
+        if (zstream)
+        {
+            inflateEnd(zstream);
+            delete zstream;
+            zstream = nullptr;
+        }
     }
-    for (int i = 0; i < num_tracks; i++) delete[] reinterpret_cast<char *>(tracks[i]);
 }
 
 // --------------------------- refactored from ffmpeg matroska decoder -----------------------
@@ -1128,11 +1408,11 @@ uint32_t MatroskaDemuxer::ebml_peek_id(int *levelUp)
 int MatroskaDemuxer::readPacket(AVPacket &avPacket)
 {
     uint32_t id;
-    if (m_lastDeliveryPacket)
+    // the previously delivered packet is consumed, so the arena is free once the queue is drained
+    if (packets.empty())
     {
-        delete[] m_lastDeliveryPacket->data;
-        delete m_lastDeliveryPacket;
-        m_lastDeliveryPacket = nullptr;
+        m_packetArena.reset();
+        m_inPlacePackets.clear();
     }
 
     // Read stream until we have a packet queued.
@@ -1143,6 +1423,13 @@ int MatroskaDemuxer::readPacket(AVPacket &avPacket)
         if (done)
             return BufferedReader::DATA_EOF;
 
+        if (m_inCluster)
+        {
+            if (matroska_parse_cluster() == -1)
+                done = true;
+            continue;
+        }
+
         int res = 0;
         while (res == 0)
         {
@@ -1161,6 +1448,8 @@ int MatroskaDemuxer::readPacket(AVPacket &avPacket)
             case MATROSKA_ID_CLUSTER:
                 if ((res = ebml_read_master(&id)) < 0)
                     break;
+                m_clusterTime = 0;
+                m_inCluster = true;
                 if ((res = matroska_parse_cluster()) == 0)
                     res = 1;  // Parsed one cluster, let's get out.
                 break;
@@ -1182,12 +1471,9 @@ int MatroskaDemuxer::readPacket(AVPacket &avPacket)
             done = true;
     }
     if (newPacket)
-    {
-        memcpy(&avPacket, newPacket, sizeof(AVPacket));
-    }
+        avPacket = *newPacket;
     else
-        avPacket = *new AVPacket();
-    m_lastDeliveryPacket = newPacket;
+        avPacket = AVPacket();
     return 0;
 }
 
@@ -1305,6 +1591,9 @@ int MatroskaDemuxer::matroska_read_header()
         /* file index (if seekable, seek to Cues/Tags to parse it) */
         case MATROSKA_ID_SEEKHEAD:
         {
+            // parsed on demand by seekToTime
+            if (m_seekHeadPos == -1)
+                m_seekHeadPos = m_processedBytes - 4;
             ebml_read_skip();
             break;
         }
@@ -1313,6 +1602,8 @@ int MatroskaDemuxer::matroska_read_header()
         {
             /* Do not read the master - this will be done in the next
              * call to matroska_read_packet. */
+            m_firstClusterPos = m_processedBytes - 4;
+            m_clusterLevels = num_levels;
             res = 1;
             break;
         }
@@ -1384,6 +1675,8 @@ int MatroskaDemuxer::matroska_read_header()
             {
                 track->parsed_priv_data = new ParsedPGTrackData();
             }
+            if (track->parsed_priv_data)
+                track->parsed_priv_data->setArena(&m_packetArena);
         }
         res = 0;
     }
@@ -4,6 +4,8 @@
 #include "ioContextDemuxer.h"
 #include "matroskaParser.h"
 
+struct z_stream_s;
+
 class MatroskaDemuxer final : public IOContextDemuxer
 {
    public:
@@ -23,6 +25,7 @@ class MatroskaDemuxer final : public IOContextDemuxer
     }
 
     [[nodiscard]] int64_t getFileDurationNano() const override { return fileDuration; }
+    bool seekToTime(int64_t time, const PIDSet &pids, std::map<int32_t, int64_t> &timeOffsets) override;
 
    private:
     typedef Track MatroskaTrack;
@@ -63,7 +66,18 @@ class MatroskaDemuxer final : public IOContextDemuxer
     bool metadata_parsed;
     int num_streams;
 
-    AVPacket *m_lastDeliveryPacket;
+    MemoryArena m_packetArena;  // queued packets and their data, reset when the queue is drained
+    MemoryBlock m_blockBuffer;
+    uint8_t *m_blockData;  // payload of the current Block/SimpleBlock, in the read buffer or in m_blockBuffer
+    int m_blockSize;
+    bool m_blockInPlace;
+    std::vector<AVPacket *> m_inPlacePackets;  // queued packets which point to the read buffer
+    std::vector<int> m_laceSizes;
+    int64_t m_clusterTime;
+    bool m_inCluster;  // cluster parsing is paused to deliver the queued packets
+    int64_t m_firstClusterPos;  // -1 until the header parsing reaches the first cluster
+    int m_clusterLevels;        // EBML level depth at the cluster elements
+    int64_t m_seekHeadPos;
 
     uint32_t ebml_peek_id(int *levelUp);
     int ebml_read_element_id(uint32_t *id, int *levelUp);
@@ -71,13 +85,15 @@ class MatroskaDemuxer final : public IOContextDemuxer
     int ebml_read_element_level_up();
     int matroska_parse_cluster();
     int ebml_read_binary(uint32_t *id, uint8_t **binary, int *size);
+    int ebml_read_block(uint32_t *id);
+    void releaseReadBuffer() override;
     int ebml_read_element_length(int64_t *length);
     int ebml_read_master(uint32_t *id);
     int ebml_read_skip();
     int ebml_read_uint(uint32_t *id, int64_t *num);
     int ebml_read_sint(uint32_t *id, int64_t *num);
     static int matroska_ebmlnum_sint(const uint8_t *data, int32_t size, int64_t *num);
-    int matroska_parse_blockgroup(int64_t cluster_time);
+    int matroska_parse_blockgroup();
     static int matroska_ebmlnum_uint(const uint8_t *data, int32_t size, uint64_t *num);
     [[nodiscard]] int matroska_find_track_by_num(int64_t num) const;
     int matroska_parse_block(uint8_t *data, int size, int64_t pos, int64_t cluster_time, int64_t duration,
@@ -89,6 +105,9 @@ class MatroskaDemuxer final : public IOContextDemuxer
     int ebml_read_header(char **doctype, int *version);
     int ebml_read_ascii(uint32_t *id, char **str);
     int matroska_parse_index();
+    int64_t findCuesPosition();
+    int64_t scanClusterTimecodes(int64_t pos, std::map<int, int64_t> &firstTimecodes);
+    void restartAtCluster(int64_t pos);
     int matroska_parse_info();
     int ebml_read_date(uint32_t *id, int64_t *date);
     int ebml_read_float(uint32_t *id, double *num);
@@ -104,10 +123,11 @@ class MatroskaDemuxer final : public IOContextDemuxer
     int readTrackEncodings(MatroskaTrack *track);
     int readTrackEncoding(MatroskaTrack *track);
     int readEncodingCompression(MatroskaTrack *track);
-    void decompressData(uint8_t *data, int size);
+    void decompressData(int track, const uint8_t *data, int size);
 
     std::map<uint64_t, AVChapter> chapters;
     MemoryBlock m_tmpBuffer;
+    z_stream_s *m_inflateContexts[MAX_STREAMS];  // zlib ContentCompression, created on first use
 };
 
 #endif
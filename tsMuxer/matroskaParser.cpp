@@ -144,7 +144,7 @@ void ParsedH264TrackData::extractData(AVPacket* pkt, uint8_t* buff, const int si
         LTRACE(LT_ERROR, 2, "Matroska parse error: invalid H264 NAL unit size. NAL unit truncated.");
     }
     newBufSize += elements * (4 - m_nalSize);
-    pkt->data = new uint8_t[newBufSize];
+    pkt->data = allocPacketData(newBufSize);
     pkt->size = newBufSize;
 
     uint8_t* dst = pkt->data;
@@ -265,7 +265,7 @@ void ParsedVC1TrackData::extractData(AVPacket* pkt, uint8_t* buff, const int siz
     const bool addFrameHdr = !(size >= 4 && buff[0] == 0 && buff[1] == 0 && buff[2] == 1);
     if (addFrameHdr)
         pkt->size += 4;
-    pkt->data = new uint8_t[pkt->size];
+    pkt->data = allocPacketData(pkt->size);
     uint8_t* dst = pkt->data;
     if (m_firstPacket && !m_seqHeader.empty())
     {
@@ -298,7 +298,7 @@ ParsedAACTrackData::ParsedAACTrackData(uint8_t* buff, const int size) : ParsedTr
 void ParsedAACTrackData::extractData(AVPacket* pkt, uint8_t* buff, const int size)
 {
     pkt->size = size + AAC_HEADER_LEN;
-    pkt->data = new uint8_t[pkt->size];
+    pkt->data = allocPacketData(pkt->size);
     m_aacRaw.buildADTSHeader(pkt->data, size + AAC_HEADER_LEN);
     memcpy(pkt->data + AAC_HEADER_LEN, buff, size);
 }
@@ -321,7 +321,7 @@ ParsedLPCMTrackData::ParsedLPCMTrackData(MatroskaTrack* track)
 void ParsedLPCMTrackData::extractData(AVPacket* pkt, uint8_t* buff, const int size)
 {
     pkt->size = size + static_cast<int>(m_waveBuffer.size());
-    pkt->data = new uint8_t[pkt->size];
+    pkt->data = allocPacketData(pkt->size);
     uint8_t* dst = pkt->data;
     if (!m_waveBuffer.isEmpty())
     {
@@ -352,7 +352,7 @@ void ParsedAC3TrackData::extractData(AVPacket* pkt, uint8_t* buff, const int siz
     }
     m_firstPacket = false;
     pkt->size = size + (m_shortHeaderMode ? 2 : 0);
-    pkt->data = new uint8_t[pkt->size];
+    pkt->data = allocPacketData(pkt->size);
     uint8_t* dst = pkt->data;
     if (m_shortHeaderMode)
     {
@@ -382,7 +382,7 @@ void ParsedSRTTrackData::extractData(AVPacket* pkt, uint8_t* buff, const int siz
     prefix += '\n';
     const std::string postfix = "\n\n";
     pkt->size = static_cast<int>(size + prefix.length() + postfix.length());
-    pkt->data = new uint8_t[pkt->size];
+    pkt->data = allocPacketData(pkt->size);
     memcpy(pkt->data, prefix.c_str(), prefix.length());
     memcpy(pkt->data + prefix.length(), buff, size);
     memcpy(pkt->data + prefix.length() + size, postfix.c_str(), postfix.length());
@@ -413,7 +413,7 @@ void ParsedPGTrackData::extractData(AVPacket* pkt, uint8_t* buff, const int size
     }
 
     pkt->size = size + PG_HEADER_SIZE * blocks;
-    pkt->data = new uint8_t[pkt->size];
+    pkt->data = allocPacketData(pkt->size);
     curPtr = buff;
     uint8_t* dst = pkt->data;
     while (curPtr <= end - 3)
@@ -5,7 +5,10 @@
 
 #include <fs/textfile.h>
 #include <types/types.h>
+#include <algorithm>
+#include <atomic>
 #include <climits>
+#include <thread>
 
 #include "aacStreamReader.h"
 #include "ac3StreamReader.h"
@@ -36,6 +39,19 @@ using namespace std;
 
 static constexpr int MAX_DEMUX_BUFFER_SIZE = 1024 * 1024 * 192;
 static constexpr int MIN_READED_BLOCK = 16384;
+static constexpr unsigned MIN_PROBE_THREADS = 4;
+
+// true if a stream detection step gives the same tracks as the previous one
+static bool sameDetection(const vector<CheckStreamRez>& rez, const vector<CheckStreamRez>& prevRez)
+{
+    return std::equal(rez.begin(), rez.end(), prevRez.begin(), prevRez.end(),
+                      [](const CheckStreamRez& a, const CheckStreamRez& b) {
+                          return a.trackID == b.trackID && a.codecInfo.programName == b.codecInfo.programName &&
+                                 a.streamDescr == b.streamDescr && a.lang == b.lang && a.delay == b.delay &&
+                                 a.multiSubStream == b.multiSubStream && a.isSecondary == b.isSecondary &&
+                                 a.unused == b.unused;
+                      });
+}
 
 METADemuxer::METADemuxer(const BufferedReaderManager& readManager)
     : m_containerReader(*this, readManager), m_readManager(readManager)
@@ -545,6 +561,33 @@ int METADemuxer::addStream(const string& codec, const string& codecStreamName, c
     return streamIndex;
 }
 
+void METADemuxer::seekToTime(const int64_t time)
+{
+    for (auto& [streamName, demuxerData] : m_containerReader.m_demuxers)
+    {
+        if (demuxerData.m_iterator || !demuxerData.m_demuxer)
+            continue;  // joined files are read in sequence
+
+        // a shifted track needs data from an earlier point of the file
+        int64_t seekTime = time;
+        for (const StreamInfo& si : m_codecInfo)
+        {
+            if (si.m_dataReader == &m_containerReader && si.m_streamName == streamName)
+                seekTime = FFMIN(seekTime, time - si.m_timeShift);
+        }
+        std::map<int32_t, int64_t> timeOffsets;
+        if (seekTime <= 0 || !demuxerData.m_demuxer->seekToTime(seekTime, demuxerData.m_pidSet, timeOffsets))
+            continue;
+
+        for (const StreamInfo& si : m_codecInfo)
+        {
+            if (si.m_dataReader == &m_containerReader && si.m_streamName == streamName)
+                si.m_streamReader->setTimeOffset(si.m_streamReader->getTimeOffset() + timeOffsets[si.m_pid]);
+        }
+        LTRACE(LT_INFO, 2, "Skipping to the index point before the cut start in " << streamName);
+    }
+}
+
 void METADemuxer::readClose()
 {
     for (const auto& codecInfo : m_codecInfo)
@@ -571,7 +614,7 @@ DetectStreamRez METADemuxer::DetectStreamReader(const BufferedReaderManager& rea
     {
         demuxer = new TSDemuxer(readManager, "");
         containerType = AbstractStreamReader::ContainerType::ctM2TS;
-        string clpiFileName = findBluRayFile(extractFileDir(unquoted), "CLIPINF", extractFileName(unquoted) + ".clpi");
+        const string clpiFileName = findClpiFile(fileName);
         if (!clpiFileName.empty())
             clpiParsed = clpi.parse(clpiFileName.c_str());
     }
@@ -618,46 +661,78 @@ DetectStreamRez METADemuxer::DetectStreamReader(const BufferedReaderManager& rea
             vect.reserve(fileBlockSize);
         }
 
-        for (unsigned i = 0; i < DETECT_STREAM_BUFFER_SIZE / fileBlockSize; i++)
-            demuxer->simpleDemuxBlock(demuxedData, acceptedPidSet, discardedSize);
-
-        for (auto& itr : demuxedData)
+        // demux in doubling steps, stop when every track has data and two steps in a row detect the same
+        const bool allTracksKnown = containerType != AbstractStreamReader::ContainerType::ctVOB &&
+                                    containerType != AbstractStreamReader::ContainerType::ctEVOB;
+        const unsigned maxBlocks = DETECT_STREAM_BUFFER_SIZE / fileBlockSize;
+        vector<CheckStreamRez> detected, prevDetected;
+        PIDSet tracksWithData, prevTracksWithData;
+        bool eof = false;
+        for (unsigned blocks = 0, stepBlocks = FFMAX(DETECT_STREAM_STEP_SIZE / fileBlockSize, 1u);;
+             stepBlocks = FFMIN(stepBlocks * 2, maxBlocks))
         {
-            StreamData& vect = itr.second;
-            CheckStreamRez trackRez = detectTrackReader(vect.data(), static_cast<int>(vect.size()), containerType,
-                                                        acceptedPidMap[itr.first].m_trackType, itr.first);
-            if (!trackRez.codecInfo.programName.empty())
-            {
-                if (trackRez.codecInfo.programName[0] != 'S')
-                    trackRez.delay = demuxer->getTrackDelay(itr.first);
-            }
-            trackRez.trackID = itr.first;
-            trackRez.lang = acceptedPidMap[trackRez.trackID].m_lang;
-            if (clpiParsed)
-            {
-                map<int, CLPIStreamInfo>::const_iterator clpiStream = clpi.m_streamInfo.find(itr.first);
-                if (clpiStream != clpi.m_streamInfo.end())
-                    trackRez.lang = clpiStream->second.language_code;
-            }
-            // correct ISO 639-2/B codes to ISO 639-2/T
-            static const std::string langB[24] = {
-                "alb", "arm", "baq", "bur", "cze", "chi", "dut", "ger", "gre", "fre", "geo", "ice",
-                "jaw", "mac", "mao", "may", "mol", "per", "rum", "scc", "scr", "slo", "tib", "wel",
-            };
-            static const std::string langT[24] = {
-                "sqi", "hye", "eus", "mya", "ces", "zho", "nld", "deu", "ell", "fra", "kat", "isl",
-                "jav", "mkd", "mri", "fas", "rom", "msa", "ron", "srp", "hrv", "slk", "bod", "cym",
-            };
-            for (int i = 0; i < 24; i++)
-                if (trackRez.lang == langB[i])
-                    trackRez.lang = langT[i];
-
-            if (strStartWith(trackRez.codecInfo.programName, "A_") && dynamic_cast<TSDemuxer*>(demuxer))
+            for (; blocks < stepBlocks && !eof; blocks++)
+                eof = demuxer->simpleDemuxBlock(demuxedData, acceptedPidSet, discardedSize) == BufferedReader::DATA_EOF;
+
+            prevDetected.swap(detected);
+            detected.clear();
+            for (auto& itr : demuxedData)
             {
-                if (trackRez.trackID >= 0x1A00)
-                    trackRez.isSecondary = true;
+                StreamData& vect = itr.second;
+                CheckStreamRez trackRez = detectTrackReader(vect.data(), static_cast<int>(vect.size()), containerType,
+                                                            acceptedPidMap[itr.first].m_trackType, itr.first);
+                if (!trackRez.codecInfo.programName.empty())
+                {
+                    if (trackRez.codecInfo.programName[0] != 'S')
+                        trackRez.delay = demuxer->getTrackDelay(itr.first);
+                }
+                trackRez.trackID = itr.first;
+                trackRez.lang = acceptedPidMap[trackRez.trackID].m_lang;
+                if (clpiParsed)
+                {
+                    map<int, CLPIStreamInfo>::const_iterator clpiStream = clpi.m_streamInfo.find(itr.first);
+                    if (clpiStream != clpi.m_streamInfo.end())
+                        trackRez.lang = clpiStream->second.language_code;
+                }
+                // correct ISO 639-2/B codes to ISO 639-2/T
+                static const std::string langB[24] = {
+                    "alb", "arm", "baq", "bur", "cze", "chi", "dut", "ger", "gre", "fre", "geo", "ice",
+                    "jaw", "mac", "mao", "may", "mol", "per", "rum", "scc", "scr", "slo", "tib", "wel",
+                };
+                static const std::string langT[24] = {
+                    "sqi", "hye", "eus", "mya", "ces", "zho", "nld", "deu", "ell", "fra", "kat", "isl",
+                    "jav", "mkd", "mri", "fas", "rom", "msa", "ron", "srp", "hrv", "slk", "bod", "cym",
+                };
+                for (int i = 0; i < 24; i++)
+                    if (trackRez.lang == langB[i])
+                        trackRez.lang = langT[i];
+
+                if (strStartWith(trackRez.codecInfo.programName, "A_") && dynamic_cast<TSDemuxer*>(demuxer))
+                {
+                    if (trackRez.trackID >= 0x1A00)
+                        trackRez.isSecondary = true;
+                }
+                detected.push_back(trackRez);
             }
+            if (eof || blocks >= maxBlocks)
+                break;
+            // the demuxers create an empty slot for every accepted track, so a track counts only once it had data
+            // in two steps in a row. Its result may stay empty: tsMuxer does not know every codec
+            prevTracksWithData.swap(tracksWithData);
+            tracksWithData.clear();
+            for (const auto& itr : demuxedData)
+                if (!itr.second.isEmpty())
+                    tracksWithData.insert(itr.first);
+            bool allTracksFound = true;
+            if (allTracksKnown)
+                for (const auto& itr : acceptedPidMap)
+                    allTracksFound &= tracksWithData.count(itr.first) && prevTracksWithData.count(itr.first);
+            if (!detected.empty() && allTracksFound && sameDetection(detected, prevDetected))
+                break;
+        }
 
+        for (const CheckStreamRez& trackRez : detected)
+        {
             if (strStartWith(trackRez.codecInfo.programName, "V_"))
                 addTrack(Vstreams, trackRez);
             else
@@ -674,22 +749,35 @@ DetectStreamRez METADemuxer::DetectStreamReader(const BufferedReaderManager& rea
         containerType = AbstractStreamReader::ContainerType::ctNone;
         if (!file.open(fileName.c_str(), File::ofRead))
             return {};
-        auto tmpBuffer = new uint8_t[DETECT_STREAM_BUFFER_SIZE];
-        int len = file.read(tmpBuffer, DETECT_STREAM_BUFFER_SIZE);
         if (fileExt == "sup")
             containerType = AbstractStreamReader::ContainerType::ctSUP;
         else if (fileExt == "pcm" || fileExt == "lpcm" || fileExt == "wav" || fileExt == "w64")
             containerType = AbstractStreamReader::ContainerType::ctLPCM;
         else if (fileExt == "srt")
             containerType = AbstractStreamReader::ContainerType::ctSRT;
-        CheckStreamRez trackRez = detectTrackReader(tmpBuffer, len, containerType, 0, 0);
+        // read in doubling steps, stop when two steps in a row detect the same. The buffer grows with the step
+        vector<uint8_t> tmpBuffer;
+        int len = 0;
+        vector<CheckStreamRez> detected(1), prevDetected;
+        constexpr int maxLen = DETECT_STREAM_BUFFER_SIZE;
+        for (int stepSize = DETECT_STREAM_STEP_SIZE;; stepSize = FFMIN(stepSize * 2, maxLen))
+        {
+            tmpBuffer.resize(stepSize);
+            const int readLen = file.read(tmpBuffer.data() + len, stepSize - len);
+            len += FFMAX(readLen, 0);
+            prevDetected.swap(detected);
+            detected.assign(1, detectTrackReader(tmpBuffer.data(), len, containerType, 0, 0));
+            if (len < stepSize || len >= maxLen)
+                break;
+            if (!detected[0].codecInfo.programName.empty() && sameDetection(detected, prevDetected))
+                break;
+        }
+        const CheckStreamRez& trackRez = detected[0];
 
         if (strStartWith(trackRez.codecInfo.programName, "V_"))
             addTrack(Vstreams, trackRez);
         else
             addTrack(streams, trackRez);
-
-        delete[] tmpBuffer;
     }
     Vstreams.insert(Vstreams.end(), streams.begin(), streams.end());
 
@@ -700,6 +788,39 @@ DetectStreamRez METADemuxer::DetectStreamReader(const BufferedReaderManager& rea
     return rez;
 }
 
+vector<DetectStreamRez> METADemuxer::DetectStreamReaders(const BufferedReaderManager& readManager,
+                                                         const vector<string>& fileNames, const bool calcDuration)
+{
+    // files are probed on a pool of threads, the results and the messages keep the order of the file names
+    vector<DetectStreamRez> rez(fileNames.size());
+    atomic<size_t> nextFile{0};
+    auto worker = [&]() {
+        for (size_t i = nextFile++; i < fileNames.size(); i = nextFile++)
+        {
+            LogCapture capture;
+            sLogCapture = &capture;
+            try
+            {
+                rez[i] = DetectStreamReader(readManager, fileNames[i], calcDuration);
+            }
+            catch (...)
+            {
+                rez[i].error = current_exception();
+            }
+            sLogCapture = nullptr;
+            rez[i].messages = capture.out.str();
+            rez[i].warnings = capture.err.str();
+        }
+    };
+    // probing mostly waits for the file reads, use some threads even on a single core
+    const size_t threadCnt = FFMIN(FFMAX(thread::hardware_concurrency(), MIN_PROBE_THREADS), fileNames.size());
+    vector<thread> threads;
+    for (size_t i = 1; i < threadCnt; i++) threads.emplace_back(worker);
+    worker();
+    for (auto& t : threads) t.join();
+    return rez;
+}
+
 void METADemuxer::addTrack(vector<CheckStreamRez>& rez, CheckStreamRez trackRez)
 {
     if (trackRez.codecInfo.codecID == h264DepCodecInfo.codecID && trackRez.multiSubStream)
@@ -1154,6 +1275,15 @@ std::vector<MPLSParser> METADemuxer::getMplsInfo(const string& mplsFileName)
     return result;
 }
 
+string METADemuxer::findClpiFile(const string& fileName)
+{
+    const string unquoted = unquoteStr(fileName);
+    const string fileExt = strToLowerCase(extractFileExt(unquoted));
+    if (fileExt != "m2ts" && fileExt != "mts" && fileExt != "ssif")
+        return "";
+    return findBluRayFile(extractFileDir(unquoted), "CLIPINF", extractFileName(unquoted) + ".clpi");
+}
+
 string METADemuxer::findBluRayFile(const string& streamDir, const string& requestDir, const string& requestFile)
 {
     string dirName = streamDir.substr(0, streamDir.size() - 1);
@@ -1284,7 +1414,7 @@ uint8_t* ContainerToReaderWrapper::readBlock(const int readerID, uint32_t& readC
         }
         demuxerData.m_firstRead = false;
     }
-    StreamData& streamData = demuxerData.demuxedData[pid];
+    StreamData& streamData = *itr->second.m_streamData;
 
     const uint32_t lastReadCnt = demuxerData.lastReadCnt[pid];
     if (lastReadCnt > 0)
@@ -1390,6 +1520,10 @@ void ContainerToReaderWrapper::deleteReader(const int readerID)
     if (itr == m_readerInfo.end())
         return;
     const ReaderInfo& ri = itr->second;
+    LTRACE(LT_DEBUG, 0,
+           "Demux buffer of track " << ri.m_pid << " (" << ri.m_demuxerData.m_streamName << "): peak "
+                                    << ri.m_streamData->getPeakSize() << " bytes, "
+                                    << ri.m_streamData->getReallocCount() << " reallocations");
     ri.m_demuxerData.m_pids.erase(ri.m_pid);
     if (ri.m_demuxerData.m_pids.empty())
     {
@@ -1435,6 +1569,18 @@ bool ContainerToReaderWrapper::openStream(int readerID, const char* streamName,
         demuxer->setFileIterator(m_demuxers[streamName].m_iterator);
 
         demuxer->openFile(streamName);
+
+        const auto tsDemuxer = dynamic_cast<TSDemuxer*>(demuxer);
+        if (tsDemuxer && !m_demuxers[streamName].m_iterator)
+        {
+            // the EP map of a Blu-ray clip gives the entry points for --cut-start
+            const string unquoted = unquoteStr(streamName);
+            const string clpiFileName = METADemuxer::findBluRayFile(extractFileDir(unquoted), "CLIPINF",
+                                                                    extractFileName(unquoted) + ".clpi");
+            CLPIParser clpi;
+            if (!clpiFileName.empty() && clpi.parse(clpiFileName.c_str()))
+                tsDemuxer->setEntryPoints(clpi);
+        }
     }
 
     if (SubTrackFilter::isSubTrack(pid))
@@ -2,6 +2,7 @@
 #define META_DEMUXER_H_
 
 #include <chrono>
+#include <exception>
 #include <map>
 #include <set>
 #include <string>
@@ -101,10 +102,14 @@ class ContainerToReaderWrapper final : public AbstractReader
 
     struct ReaderInfo
     {
-        ReaderInfo(DemuxerData& demuxerData, const int pid) : m_demuxerData(demuxerData), m_pid(pid) {}
+        ReaderInfo(DemuxerData& demuxerData, const int pid)
+            : m_demuxerData(demuxerData), m_pid(pid), m_streamData(&demuxerData.demuxedData[pid])
+        {
+        }
 
         DemuxerData& m_demuxerData;
         int m_pid;
+        StreamData* m_streamData;  // DemuxedData keeps the address
     };
 
     ContainerToReaderWrapper(const METADemuxer& owner, const BufferedReaderManager& readManager)
@@ -154,6 +159,9 @@ struct DetectStreamRez
     AVChapters chapters;
     std::vector<CheckStreamRez> streams;
     int64_t fileDurationNano;
+    std::exception_ptr error;  // set by DetectStreamReaders if the file can't be probed
+    std::string messages;      // stdout output of DetectStreamReaders while probing the file
+    std::string warnings;      // and its stderr output
 };
 
 class METADemuxer final : public AbstractDemuxer
@@ -167,14 +175,20 @@ class METADemuxer final : public AbstractDemuxer
     int addStream(const std::string& codec, const std::string& codecStreamName,
                   const std::map<std::string, std::string>& addParams);
     void openFile(const std::string& streamName) override;
+    void seekToTime(int64_t time);
     [[nodiscard]] const std::vector<StreamInfo>& getStreamInfo() const { return m_codecInfo; }
     static DetectStreamRez DetectStreamReader(const BufferedReaderManager& readManager, const std::string& fileName,
                                               bool calcDuration);
+    static std::vector<DetectStreamRez> DetectStreamReaders(const BufferedReaderManager& readManager,
+                                                            const std::vector<std::string>& fileNames,
+                                                            bool calcDuration);
     std::vector<StreamInfo>& getCodecInfo() { return m_codecInfo; }
     int getLastReadRez() override { return m_lastReadRez; }
     [[nodiscard]] int64_t totalSize() const { return m_totalSize; }
     static std::string mplsTrackToFullName(const std::string& mplsFileName, const std::string& mplsNum);
     static std::string mplsTrackToSSIFName(const std::string& mplsFileName, const std::string& mplsNum);
+    // the clip info file of a Blu-ray stream file, which gives the track languages. Empty if there is none
+    static std::string findClpiFile(const std::string& fileName);
     bool m_HevcFound;
 
    private:
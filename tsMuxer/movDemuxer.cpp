@@ -60,6 +60,121 @@ struct MOVStsc
     unsigned id;
 };
 
+static constexpr size_t MOV_TABLE_WINDOW = 4096;  // entries of a file backed table read at once
+
+// Sample size, sync sample or chunk offset table of a track. A table read from the moov atom stays in the file and is
+// read a window at a time when it is used. Tables built from the fragments or sorted are kept in memory
+class MovTable
+{
+   public:
+    MovTable() : m_file(nullptr), m_filePos(0), m_entrySize(0), m_size(0), m_windowStart(0) {}
+
+    [[nodiscard]] size_t size() const { return m_size; }
+    [[nodiscard]] bool empty() const { return m_size == 0; }
+
+    int64_t operator[](const size_t idx) const
+    {
+        if (idx - m_windowStart >= m_window.size())
+            readWindow(idx);
+        return m_window[idx - m_windowStart];
+    }
+
+    // the table is the count big-endian values of entrySize bytes at filePos
+    void setFileRange(File* file, const int64_t filePos, const size_t count, const int entrySize)
+    {
+        m_file = file;
+        m_filePos = filePos;
+        m_entrySize = entrySize;
+        m_size = count;
+        m_window.clear();
+        m_windowStart = 0;
+    }
+
+    void push_back(const int64_t value)
+    {
+        load();
+        m_window.push_back(value);
+        m_size++;
+    }
+
+    void sort()
+    {
+        load();
+        std::sort(m_window.begin(), m_window.end());
+    }
+
+    // index of the first entry greater than value, or not less than value if orEqual is set. The table is sorted
+    [[nodiscard]] size_t bound(const int64_t value, const bool orEqual) const
+    {
+        size_t first = 0;
+        size_t count = m_size;
+        while (count > 0)
+        {
+            const size_t step = count / 2;
+            const int64_t entry = (*this)[first + step];
+            if (entry < value || (!orEqual && entry == value))
+            {
+                first += step + 1;
+                count -= step + 1;
+            }
+            else
+                count = step;
+        }
+        return first;
+    }
+
+    [[nodiscard]] bool contains(const int64_t value) const
+    {
+        const size_t idx = bound(value, true);
+        return idx < m_size && (*this)[idx] == value;
+    }
+
+   private:
+    File* m_file;  // nullptr when the whole table is in m_window
+    int64_t m_filePos;
+    int m_entrySize;
+    size_t m_size;
+    mutable std::vector<int64_t> m_window;
+    mutable size_t m_windowStart;
+    mutable std::vector<uint8_t> m_buffer;
+
+    void load()
+    {
+        if (m_file == nullptr)
+            return;
+        readEntries(0, m_size);
+        m_file = nullptr;
+    }
+
+    void readWindow(const size_t idx) const
+    {
+        if (m_file == nullptr || idx >= m_size)
+            THROW(ERR_MOV_PARSE, "Table index " << idx << " is out of range")
+        const size_t start = idx - idx % MOV_TABLE_WINDOW;
+        readEntries(start, FFMIN(MOV_TABLE_WINDOW, m_size - start));
+    }
+
+    void readEntries(const size_t start, const size_t count) const
+    {
+        const size_t bytes = count * m_entrySize;
+        m_buffer.resize(bytes);
+        m_file->seek(m_filePos + static_cast<int64_t>(start * m_entrySize));
+        const int readed = m_file->read(m_buffer.data(), static_cast<uint32_t>(bytes));
+        // the values after the end of the file read as 0
+        memset(m_buffer.data() + FFMAX(readed, 0), 0, bytes - FFMAX(readed, 0));
+        m_window.resize(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            uint8_t* src = m_buffer.data() + i * m_entrySize;
+            if (m_entrySize == 8)
+                m_window[i] = static_cast<int64_t>(AV_RB32(src)) << 32 | AV_RB32(src + 4);
+            else
+                m_window[i] = AV_RB32(src);
+        }
+        m_windowStart = start;
+    }
+};
+
 /*
 int64_t av_gcd(int64_t a, int64_t b){
     if(b) return av_gcd(b, a%b);
@@ -118,12 +233,12 @@ struct MOVStreamContext : Track
 
     ~MOVStreamContext() = default;
 
-    vector<int64_t> chunk_offsets;
-    vector<uint32_t> m_index;
+    MovTable chunk_offsets;
+    MovTable m_index;
     size_t m_indexCur;
 
     unsigned ffindex;  // the ffmpeg stream id
-    int next_chunk;
+    size_t next_chunk;  // the track's next chunk to be demuxed
     unsigned int ctts_count;
     vector<MOVStsc> stsc_data;
     double fps;
@@ -146,7 +261,7 @@ struct MOVStreamContext : Track
     unsigned channels;
     int packet_size;
     int sample_rate;
-    vector<uint32_t> keyframes;
+    MovTable keyframes;
     // vector<MOVDref> drefs;
     vector<MOVStts> stts_data;
     vector<MOVStts> ctts_data;
@@ -183,7 +298,7 @@ class MovParsedAudioTrackData final : public ParsedTrackPrivData
         {
             unsigned frameSize = m_sc->sample_size;
             if (frameSize == 0)
-                frameSize = m_sc->m_index[m_sc->m_indexCur++];
+                frameSize = static_cast<unsigned>(m_sc->m_index[m_sc->m_indexCur++]);
             if (buff + frameSize > srcEnd)
                 break;
             if (isAAC)
@@ -214,7 +329,7 @@ class MovParsedAudioTrackData final : public ParsedTrackPrivData
                 if (m_sc->m_indexCur + i >= m_sc->m_index.size())
                     THROW(ERR_MOV_PARSE, "Out of index for AAC track #" << m_sc->ffindex << " at position "
                                                                         << m_demuxer->getProcessedBytes())
-                left -= m_sc->m_index[m_sc->m_indexCur + i];
+                left -= static_cast<unsigned>(m_sc->m_index[m_sc->m_indexCur + i]);
             }
         }
         if (left > 4)
@@ -607,6 +722,43 @@ class MovParsedSRTTrackData final : public ParsedTrackPrivData
     int64_t m_timeOffset;
 };
 
+// Returns the index of the first sample of each chunk, from the sample-to-chunk table
+static vector<uint32_t> chunkFirstSamples(const MOVStreamContext* st)
+{
+    vector<uint32_t> rez(st->chunk_offsets.size());
+    uint32_t sample = 0;
+    size_t stscIdx = 0;
+    for (size_t i = 0; i < rez.size(); i++)
+    {
+        while (stscIdx + 1 < st->stsc_data.size() && st->stsc_data[stscIdx + 1].first <= i + 1) stscIdx++;
+        rez[i] = sample;
+        if (!st->stsc_data.empty())
+            sample += st->stsc_data[stscIdx].count;
+    }
+    return rez;
+}
+
+// decoding time of the sample in INTERNAL_PTS_FREQ units
+static int64_t sampleTime(const MOVStreamContext* st, uint32_t sample)
+{
+    int64_t time = 0;
+    for (const MOVStts& stts : st->stts_data)
+    {
+        const uint32_t count = FFMIN(sample, stts.count);
+        time += count * stts.duration;
+        sample -= count;
+        if (sample == 0)
+            break;
+    }
+    return time / st->time_scale * INTERNAL_PTS_FREQ + time % st->time_scale * INTERNAL_PTS_FREQ / st->time_scale;
+}
+
+static bool isSyncSample(const MOVStreamContext* st, const uint32_t sample)
+{
+    // the sync sample table is 1-based, all samples are sync samples without it
+    return st->keyframes.empty() || st->keyframes.contains(sample + 1);
+}
+
 MovDemuxer::MovDemuxer(const BufferedReaderManager& readManager)
     : IOContextDemuxer(readManager), m_mdat_size(0), m_fileSize(0), m_timescale(0), fragment()
 {
@@ -618,6 +770,9 @@ MovDemuxer::MovDemuxer(const BufferedReaderManager& readManager)
     fileDuration = 0;
     isom = 0;
     m_curChunk = 0;
+    m_chunkTrack = -1;
+    m_chunkOffset = 0;
+    m_chunksReordered = false;
     m_firstDemux = true;
     m_fileIterator = nullptr;
     m_firstHeaderSize = 0;
@@ -648,10 +803,9 @@ void MovDemuxer::openFile(const std::string& streamName)
     if (!m_bufferedReader->openStream(m_readerID, streamName.c_str()))
         THROW(ERR_FILE_NOT_FOUND, "Can't open stream " << streamName)
 
-    File tmpFile;
-    tmpFile.open(streamName.c_str(), File::ofRead);
-    tmpFile.size(&m_fileSize);
-    tmpFile.close();
+    // the sample tables are read through this file while the data is demuxed
+    m_tableFile.open(streamName.c_str(), File::ofRead);
+    m_tableFile.size(&m_fileSize);
 
     m_processedBytes = 0;
     m_isEOF = false;
@@ -664,30 +818,69 @@ void MovDemuxer::openFile(const std::string& streamName)
 
 void MovDemuxer::buildIndex()
 {
+    // the chunks are demuxed in the file order by merging the chunk tables of the tracks
     m_curChunk = 0;
-    chunks.clear();
+    m_chunkTrack = -1;
+    m_chunksReordered = false;
+    for (int i = 0; i < num_tracks; ++i)
+    {
+        const auto st = reinterpret_cast<MOVStreamContext*>(tracks[i]);
+        st->next_chunk = 0;
+        bool sorted = true;
+        int64_t prevOffset = 0;
+        for (size_t j = 0; j < st->chunk_offsets.size(); j++)
+        {
+            const int64_t offset = st->chunk_offsets[j];
+            if (!found_moof && (offset < m_mdat_pos || offset > m_mdat_pos + m_mdat_size))
+                THROW(ERR_MOV_PARSE, "Invalid chunk offset " << offset)
+            if (offset < prevOffset)
+                sorted = false;
+            prevOffset = offset;
+        }
+        if (!sorted)
+        {
+            st->chunk_offsets.sort();
+            m_chunksReordered = true;
+        }
+    }
 
     if (num_tracks == 1 && reinterpret_cast<MOVStreamContext*>(tracks[0])->chunk_offsets.empty())
     {
-        chunks.emplace_back(0, 0);
+        // the whole mdat is a single chunk
+        m_chunkTrack = 0;
+        m_chunkOffset = 0;
     }
     else
     {
-        for (int i = 0; i < num_tracks; ++i)
+        selectNextChunk();
+    }
+}
+
+// Picks the first chunk in the file among the next chunks of the tracks. Ties go to the lower track
+void MovDemuxer::selectNextChunk()
+{
+    m_chunkTrack = -1;
+    for (int i = 0; i < num_tracks; ++i)
+    {
+        const auto st = reinterpret_cast<MOVStreamContext*>(tracks[i]);
+        if (st->next_chunk >= st->chunk_offsets.size())
+            continue;
+        const int64_t offset = st->chunk_offsets[st->next_chunk] - m_mdat_pos;
+        if (m_chunkTrack == -1 || offset < m_chunkOffset)
         {
-            const auto st = reinterpret_cast<MOVStreamContext*>(tracks[i]);
-            for (const auto& j : st->chunk_offsets)
-            {
-                if (!found_moof)
-                    if (j < m_mdat_pos || j > m_mdat_pos + m_mdat_size)
-                        THROW(ERR_MOV_PARSE, "Invalid chunk offset " << j)
-                chunks.emplace_back(j - m_mdat_pos, i);
-            }
+            m_chunkTrack = i;
+            m_chunkOffset = offset;
         }
-        sort(chunks.begin(), chunks.end());
     }
 }
 
+void MovDemuxer::nextChunk()
+{
+    reinterpret_cast<MOVStreamContext*>(tracks[m_chunkTrack])->next_chunk++;
+    m_curChunk++;
+    selectNextChunk();
+}
+
 void MovDemuxer::readHeaders()
 {
     // check MOV header
@@ -719,29 +912,83 @@ int MovDemuxer::simpleDemuxBlock(DemuxedData& demuxedData, const PIDSet& accepte
                 url_fseek(m_mdat_pos);
         }
         discardSize += m_mdat_pos - beforeHeadersPos;
-        if (!chunks.empty())
+        if (m_chunkTrack != -1)
         {
-            discardSize += chunks[m_curChunk].first;
-            skip_bytes(chunks[m_curChunk].first);
+            discardSize += m_chunkOffset;
+            skip_bytes(m_chunkOffset);
         }
     }
+    // what is done with the chunks of each track
+    m_trackActions.resize(num_tracks);
+    for (int i = 0; i < num_tracks; ++i)
+    {
+        if (m_pidFilters.find(i + 1) != m_pidFilters.end())
+            m_trackActions[i] = ChunkAction::Filter;
+        else if (acceptedPIDs.find(i + 1) == acceptedPIDs.end())
+            m_trackActions[i] = ChunkAction::Skip;
+        else if (tracks[i]->parsed_priv_data)
+            m_trackActions[i] = ChunkAction::Convert;
+        else
+            m_trackActions[i] = ChunkAction::Copy;
+    }
+
     const int64_t startPos = m_processedBytes;
-    while (m_processedBytes - startPos < m_fileBlockSize && m_curChunk < chunks.size())
+    while (m_processedBytes - startPos < m_fileBlockSize && m_chunkTrack != -1)
     {
-        const int64_t offset = chunks[m_curChunk].first;
+        const int64_t offset = m_chunkOffset;
+        const int trackId = m_chunkTrack;
+        const size_t chunkIdx = m_curChunk;
+        const ChunkAction action = m_trackActions[trackId];
+        nextChunk();
+        if (!found_moof && (action == ChunkAction::Skip || action == ChunkAction::Copy))
+        {
+            // the following chunks of skipped tracks, or of the same copied track, are one range of the mdat
+            const int64_t maxSize = m_fileBlockSize - (m_processedBytes - startPos);
+            while (m_chunkTrack != -1)
+            {
+                if (action == ChunkAction::Copy ? m_chunkTrack != trackId || m_chunkOffset - offset >= maxSize
+                                                : m_trackActions[m_chunkTrack] != ChunkAction::Skip)
+                    break;
+                nextChunk();
+            }
+            const int64_t end = m_chunkTrack != -1 ? m_chunkOffset : m_mdat_size;
+            const auto rangeSize = static_cast<int>(end - offset);
+            if (m_chunkTrack == -1)
+            {
+                m_firstDemux = true;
+                m_mdat_pos = 0;
+            }
+            if (action == ChunkAction::Skip)
+            {
+                discardSize += end - offset;
+                skip_bytes(end - offset);
+            }
+            else if (rangeSize)
+            {
+                MemoryBlock& vect = demuxedData[trackId + 1];
+                const size_t oldSize = vect.size();
+                vect.grow(rangeSize);
+                const int readed = static_cast<int>(get_buffer(vect.data() + oldSize, rangeSize));
+                if (readed < rangeSize)
+                    vect.grow(readed - rangeSize);
+                if (readed == 0)
+                    break;
+            }
+            continue;
+        }
+
         int64_t next;
-        if (m_curChunk < chunks.size() - 1)
-            next = chunks[m_curChunk + 1].first;
+        if (m_chunkTrack != -1)
+            next = m_chunkOffset;
         else
         {
             next = m_mdat_size;
             m_firstDemux = true;
             m_mdat_pos = 0;
         }
-        const auto chunkSize = static_cast<int>(found_moof ? m_mdat_data[m_curChunk].second : next - offset);
-        const int trackId = static_cast<int>(chunks[m_curChunk].second);
+        const auto chunkSize = static_cast<int>(found_moof ? m_mdat_data[chunkIdx].second : next - offset);
         auto filterItr = m_pidFilters.find(trackId + 1);
-        if (filterItr == m_pidFilters.end() && acceptedPIDs.find(trackId + 1) == acceptedPIDs.end())
+        if (action == ChunkAction::Skip)
         {
             discardSize += chunkSize;
             skip_bytes(chunkSize);
@@ -812,9 +1059,8 @@ int MovDemuxer::simpleDemuxBlock(DemuxedData& demuxedData, const PIDSet& accepte
                 }
             }
         }
-        if (found_moof && m_curChunk < chunks.size() - 1)
-            skip_bytes(next - offset - m_mdat_data[m_curChunk].second);
-        m_curChunk++;
+        if (found_moof && m_chunkTrack != -1)
+            skip_bytes(next - offset - m_mdat_data[chunkIdx].second);
     }
 
     if (m_processedBytes > startPos)
@@ -833,6 +1079,99 @@ int MovDemuxer::simpleDemuxBlock(DemuxedData& demuxedData, const PIDSet& accepte
     return m_lastReadRez;
 }
 
+bool MovDemuxer::seekToTime(const int64_t time, const PIDSet& pids, std::map<int32_t, int64_t>& timeOffsets)
+{
+    if (found_moof || m_fileIterator || !m_firstDemux || m_curChunk != 0 || m_mdat_pos == 0 || !m_pidFilters.empty())
+        return false;
+    // the first sample of a chunk is taken from the sample-to-chunk table, which needs the chunks in the stco order
+    if (m_chunksReordered)
+        return false;
+
+    // the chunks of the seek reference track start at a sync sample. It is the first track with a sync sample table
+    vector<int> seekTracks;
+    int refTrack = -1;
+    for (const int pid : pids)
+    {
+        if (pid < 1 || pid > num_tracks)
+            return false;
+        const auto st = reinterpret_cast<MOVStreamContext*>(tracks[pid - 1]);
+        // SRT tracks are timed from their first sample
+        if (st->type == IOContextTrackType::SUBTITLE || st->stts_data.empty() || st->time_scale == 0)
+            return false;
+        seekTracks.push_back(pid - 1);
+        if (refTrack == -1 && !st->keyframes.empty())
+            refTrack = pid - 1;
+    }
+    if (seekTracks.empty())
+        return false;
+    if (refTrack == -1)
+        refTrack = seekTracks[0];
+
+    map<int, vector<uint32_t>> firstSamples;
+    for (const int track : seekTracks)
+        firstSamples[track] = chunkFirstSamples(reinterpret_cast<MOVStreamContext*>(tracks[track]));
+
+    // index of the first chunk of the track which is demuxed at or after the chunk of the reference track at pos.
+    // Chunks of the lower tracks at the same position come first
+    const auto chunkAfter = [this, refTrack](const int track, const int64_t pos)
+    {
+        return reinterpret_cast<MOVStreamContext*>(tracks[track])->chunk_offsets.bound(pos, track >= refTrack);
+    };
+
+    // the candidates are the chunks of the reference track which start with a sync sample
+    const auto refSt = reinterpret_cast<MOVStreamContext*>(tracks[refTrack]);
+    const vector<uint32_t>& refSamples = firstSamples[refTrack];
+    int64_t startPos = -1;
+    int attempts = 0;
+    for (size_t j = refSamples.size(); j-- > 1 && attempts < MAX_SEEK_ATTEMPTS;)
+    {
+        if (!isSyncSample(refSt, refSamples[j]) || sampleTime(refSt, refSamples[j]) > time)
+            continue;
+        attempts++;
+        const int64_t pos = refSt->chunk_offsets[j];
+        bool found = true;
+        for (const int track : seekTracks)
+        {
+            const size_t k = chunkAfter(track, pos);
+            if (k < firstSamples[track].size() &&
+                sampleTime(reinterpret_cast<MOVStreamContext*>(tracks[track]), firstSamples[track][k]) > time)
+            {
+                found = false;
+                break;
+            }
+        }
+        if (found)
+        {
+            startPos = pos;
+            break;
+        }
+    }
+    if (startPos == -1)
+        return false;
+
+    m_curChunk = 0;
+    for (int track = 0; track < num_tracks; track++)
+    {
+        const auto st = reinterpret_cast<MOVStreamContext*>(tracks[track]);
+        st->next_chunk = chunkAfter(track, startPos);
+        m_curChunk += st->next_chunk;
+    }
+    for (const int track : seekTracks)
+    {
+        const auto st = reinterpret_cast<MOVStreamContext*>(tracks[track]);
+        const size_t k = st->next_chunk;
+        if (k == firstSamples[track].size())
+            continue;  // the track ends before the start point
+        st->m_indexCur = firstSamples[track][k];
+        timeOffsets[track + 1] = sampleTime(st, firstSamples[track][k]);
+    }
+    selectNextChunk();
+    url_fseek(m_mdat_pos + m_chunkOffset);
+    m_firstDemux = false;
+    m_firstHeaderSize = m_processedBytes;
+    return true;
+}
+
 void MovDemuxer::getTrackList(std::map<int32_t, TrackInfo>& trackList)
 {
     for (int i = 0; i < num_tracks; i++)
@@ -1185,6 +1524,18 @@ int MovDemuxer::mov_read_tfhd(MOVAtom atom)
 // ReSharper disable once CppMemberFunctionMayBeStatic
 int MovDemuxer::mov_read_tkhd(MOVAtom atom) { return 0; }
 
+// count/duration pairs of the time-to-sample and composition offset tables
+void MovDemuxer::readSttsTable(std::vector<MOVStts>& table)
+{
+    vector<uint32_t> values(table.size() * 2);
+    get_be32_array(values.data(), values.size());
+    for (size_t i = 0; i < table.size(); i++)
+    {
+        table[i].count = values[i * 2];
+        table[i].duration = values[i * 2 + 1];
+    }
+}
+
 int MovDemuxer::mov_read_ctts(MOVAtom atom)
 {
     const auto st = reinterpret_cast<MOVStreamContext*>(tracks[num_tracks - 1]);
@@ -1194,12 +1545,7 @@ int MovDemuxer::mov_read_ctts(MOVAtom atom)
     st->ctts_data.resize(entries);
     st->ctts_data.shrink_to_fit();
     st->ctts_count = 0;
-    for (unsigned i = 0; i < entries; i++)
-    {
-        st->ctts_data[i].count = get_be32();
-        st->ctts_data[i].duration = get_be32();
-        // st->time_rate= av_gcd(st->time_rate, abs(st->ctts_data[i].duration));
-    }
+    readSttsTable(st->ctts_data);
     return 0;
 }
 
@@ -1210,15 +1556,9 @@ int MovDemuxer::mov_read_stts(MOVAtom atom)
     get_be24();  // flags
     const unsigned entries = get_be32();
     st->stts_data.resize(entries);
-    for (unsigned i = 0; i < entries; i++)
-    {
-        st->stts_data[i].count = get_be32();
-        st->stts_data[i].duration = get_be32();
-        if (i == 0)
-        {
-            st->fps = st->time_scale / static_cast<double>(st->stts_data[i].duration);
-        }
-    }
+    readSttsTable(st->stts_data);
+    if (entries > 0)
+        st->fps = st->time_scale / static_cast<double>(st->stts_data[0].duration);
     return 0;
 }
 
@@ -1233,10 +1573,22 @@ int MovDemuxer::mov_read_stsz(MOVAtom atom)
         return 0;
     if (entries >= UINT_MAX / sizeof(int))
         return -1;
-    for (size_t i = 0; i < entries; i++) st->m_index.push_back(get_be32());
+    readTable(st->m_index, entries, 4);
     return 0;
 }
 
+// The entries of the first table atom of a track are left in the file and read when they are used
+void MovDemuxer::readTable(MovTable& table, const unsigned entries, const int entrySize)
+{
+    if (table.empty())
+    {
+        table.setFileRange(&m_tableFile, m_processedBytes, entries, entrySize);
+        skip_bytes(static_cast<uint64_t>(entries) * entrySize);
+        return;
+    }
+    for (unsigned i = 0; i < entries; i++) table.push_back(entrySize == 8 ? get_be64() : get_be32());
+}
+
 int MovDemuxer::mov_read_stss(MOVAtom atom)
 {
     const auto st = reinterpret_cast<MOVStreamContext*>(tracks[num_tracks - 1]);
@@ -1248,7 +1600,7 @@ int MovDemuxer::mov_read_stss(MOVAtom atom)
         return 0;
     if (entries >= UINT_MAX / sizeof(int))
         return -1;
-    for (size_t i = 0; i < entries; i++) st->keyframes.push_back(get_be32());
+    readTable(st->keyframes, entries, 4);
     return 0;
 }
 
@@ -1556,9 +1908,9 @@ int MovDemuxer::mov_read_stco(MOVAtom atom)
     // sc->chunk_count = entries;
 
     if (atom.type == MKTAG('s', 't', 'c', 'o'))
-        for (unsigned i = 0; i < entries; i++) sc->chunk_offsets.push_back(get_be32());
+        readTable(sc->chunk_offsets, entries, 4);
     else if (atom.type == MKTAG('c', 'o', '6', '4'))
-        for (unsigned i = 0; i < entries; i++) sc->chunk_offsets.push_back(get_be64());
+        readTable(sc->chunk_offsets, entries, 8);
     else
         return -1;
 
@@ -6,9 +6,14 @@
 #include <string>
 #include <vector>
 
+#include <fs/file.h>
+
 #include "bufferedReaderManager.h"
 #include "ioContextDemuxer.h"
 
+struct MOVStts;
+class MovTable;
+
 class MovDemuxer final : public IOContextDemuxer
 {
    public:
@@ -27,6 +32,7 @@ class MovDemuxer final : public IOContextDemuxer
     void setFileIterator(FileNameIterator* itr) override;
     [[nodiscard]] bool isPidFilterSupported() const override { return true; }
     [[nodiscard]] int64_t getFileDurationNano() const override;
+    bool seekToTime(int64_t time, const PIDSet& pids, std::map<int32_t, int64_t>& timeOffsets) override;
 
    private:
     struct MOVAtom
@@ -52,6 +58,14 @@ class MovDemuxer final : public IOContextDemuxer
         unsigned flags;
     };
 
+    enum class ChunkAction
+    {
+        Skip,
+        Copy,     // appended to the track data as is
+        Convert,  // rebuilt by the track's parsed_priv_data
+        Filter    // passed to the sub track filter
+    };
+
     struct MOVTrackExt
     {
         int track_id;
@@ -77,19 +91,27 @@ class MovDemuxer final : public IOContextDemuxer
     std::vector<MOVTrackExt> trex_data;
     int64_t fileDuration;
     int isom;
-    std::vector<std::pair<int64_t, int64_t>> chunks;
-    size_t m_curChunk;
+    size_t m_curChunk;       // number of chunks demuxed since the index was built
+    int m_chunkTrack;        // track of the next chunk in the file, -1 at the end of the index
+    int64_t m_chunkOffset;   // and its offset from the mdat start
+    bool m_chunksReordered;  // a chunk offset table was sorted, so it no longer matches the sample-to-chunk table
     AVPacket m_deliveredPacket;
     std::vector<uint8_t> m_tmpChunkBuffer;
     bool m_firstDemux;
     FileNameIterator* m_fileIterator;
     std::string m_fileName;
     MemoryBlock m_filterBuffer;
+    std::vector<ChunkAction> m_trackActions;  // per track, for the current simpleDemuxBlock call
     int64_t m_firstHeaderSize;
+    File m_tableFile;
 
     void readHeaders();
     void buildIndex();
+    void selectNextChunk();
+    void nextChunk();
     int ParseTableEntry(MOVAtom atom);
+    void readSttsTable(std::vector<MOVStts>& table);
+    void readTable(MovTable& table, unsigned entries, int entrySize);
     int mov_read_default(MOVAtom atom);
     int mov_read_extradata(MOVAtom atom);
     int mov_read_mdat(MOVAtom atom);
@@ -25,6 +25,7 @@ void MPEGStreamReader::setBuffer(uint8_t* data, const uint32_t dataLen, const bo
     if (m_tmpBufferLen + dataLen > TMP_BUFFER_SIZE)
         THROW(ERR_COMMON_SMALL_BUFFER,
               "Not enough buffer for parse video stream. Current frame num " << m_totalFrameNum)
+    releasePacketData();
     memcpy(m_tmpBuffer + m_tmpBufferLen, data + MAX_AV_PACKET_SIZE, dataLen);
     m_tmpBufferLen += dataLen;
 
@@ -84,6 +85,7 @@ void MPEGStreamReader::onShiftBuffer(int offset) {}
 void MPEGStreamReader::storeBufferRest()
 {
     onShiftBuffer(static_cast<int>(m_curPos - m_tmpBuffer));
+    releasePacketData();
     memmove(m_tmpBuffer, m_curPos, m_bufEnd - m_curPos);
     m_tmpBufferLen = static_cast<int>(m_bufEnd - m_curPos);
     if (m_lastDecodedPos > m_curPos)
@@ -57,6 +57,7 @@ class MPEGStreamReader : public AbstractStreamReader
     void setRemovePulldown(const bool value) { m_removePulldown = value; }
     virtual int getFrameDepth() { return 1; }
     virtual void onShiftBuffer(int offset);
+    [[nodiscard]] bool isPacketDataStable() const override { return true; }
 
    protected:
     VideoAspectRatio m_ar;
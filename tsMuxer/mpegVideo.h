@@ -42,21 +42,7 @@ class MPEGHeader
    public:
     static uint8_t* findNextMarker(uint8_t* buffer, uint8_t* end)
     {
-        // uint8_t* bufStart = buffer;
-        for (buffer += 2; buffer < end;)
-        {
-            if (*buffer > 1)
-                buffer += 3;
-            else if (*buffer == 0)
-                buffer++;
-            else  // *buffer == 1
-            {
-                if (buffer[-2] == 0 && buffer[-1] == 0)
-                    return buffer - 2;
-                buffer += 3;
-            }
-        }
-        return end;
+        return findStartCode(buffer, end);
     }
 
    protected:
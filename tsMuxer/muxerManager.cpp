@@ -207,6 +207,8 @@ void MuxerManager::checkTrackList(const vector<StreamInfo>& ci) const
 
 void MuxerManager::doMux(const string& outFileName, FileFactory* fileFactory)
 {
+    if (m_cutStart > 0)
+        m_metaDemuxer.seekToTime(m_cutStart);
     preinitMux(outFileName, fileFactory);
 
     m_fileWriter = new BufferedFileWriter();
@@ -336,6 +338,8 @@ int MuxerManager::syncWriteBuffer(AbstractMuxer* muxer, const uint8_t* buff, con
 void MuxerManager::parseMuxOpt(const string& opts)
 {
     const vector<string> params = splitQuotedStr(opts.c_str(), ' ');
+    bool dryRun = false;
+    OutputSinkType sinkType = OutputSinkType::None;
     for (auto& i : params)
     {
         vector<string> paramPair = splitStr(trimStr(i).c_str(), '=');
@@ -396,7 +400,20 @@ void MuxerManager::parseMuxOpt(const string& opts)
         {
             m_reproducibleIsoHeader = true;
         }
+        else if (paramPair[0] == "--dry-run")
+        {
+            dryRun = true;
+        }
+        else if (paramPair[0] == "--output-sink" && paramPair.size() > 1)
+        {
+            sinkType = outputSinkTypeFromString(paramPair[1]);
+        }
     }
+    // an explicit --output-sink wins over --dry-run, whatever the argument order
+    if (sinkType != OutputSinkType::None)
+        m_outputSink = sinkType;
+    else if (dryRun)
+        m_outputSink = OutputSinkType::Discard;
 }
 
 void MuxerManager::waitForWriting() const
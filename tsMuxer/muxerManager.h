@@ -5,6 +5,7 @@
 #include "bufferedFileWriter.h"
 #include "bufferedReaderManager.h"
 #include "metaDemuxer.h"
+#include "outputSink.h"
 
 class FileFactory;
 
@@ -55,6 +56,7 @@ class MuxerManager final
     [[nodiscard]] int getExtraISOBlocks() const { return m_extraIsoBlocks; }
 
     [[nodiscard]] bool useReproducibleIsoHeader() const { return m_reproducibleIsoHeader; }
+    [[nodiscard]] OutputSinkType getOutputSink() const { return m_outputSink; }
 
     enum class SubTrackMode
     {
@@ -97,6 +99,7 @@ class MuxerManager final
     bool m_bluRayMode;
     bool m_demuxMode;
     bool m_reproducibleIsoHeader = false;
+    OutputSinkType m_outputSink = OutputSinkType::None;
 };
 
 #endif  // _MUXER_MANAGER_H_
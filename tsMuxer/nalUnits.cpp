@@ -60,43 +60,17 @@ uint8_t* NALUnit::addStartCode(uint8_t* buffer, const uint8_t* boundStart)
 
 uint8_t* NALUnit::findNextNAL(uint8_t* buffer, uint8_t* end)
 {
-    for (buffer += 2; buffer < end;)
-    {
-        if (*buffer > 1)
-            buffer += 3;
-        else if (*buffer == 0)
-            buffer++;
-        else  // *buffer == 1
-        {
-            if (buffer[-2] == 0 && buffer[-1] == 0)
-                return buffer + 1;
-            buffer += 3;
-        }
-    }
-    return end;
+    buffer = findStartCode(buffer, end);
+    return buffer < end ? buffer + 3 : end;
 }
 
 uint8_t* NALUnit::findNALWithStartCode(uint8_t* buffer, uint8_t* end, const bool longCodesAllowed)
 {
     const uint8_t* bufStart = buffer;
-    for (buffer += 2; buffer < end;)
-    {
-        if (*buffer > 1)
-            buffer += 3;
-        else if (*buffer == 0)
-            buffer++;
-        else  // *buffer == 1
-        {
-            if (buffer[-2] == 0 && buffer[-1] == 0)
-            {
-                if (longCodesAllowed && buffer - 3 >= bufStart && buffer[-3] == 0)
-                    return buffer - 3;
-                return buffer - 2;
-            }
-            buffer += 3;
-        }
-    }
-    return end;
+    buffer = findStartCode(buffer, end);
+    if (buffer < end && longCodesAllowed && buffer > bufStart && buffer[-1] == 0)
+        return buffer - 1;
+    return buffer;
 }
 
 int NALUnit::encodeNAL(const uint8_t* srcBuffer, const uint8_t* srcEnd, uint8_t* dstBuffer, size_t dstBufferSize)
@@ -14,6 +14,7 @@
 
 #include <algorithm>
 #include <map>
+#include <mutex>
 
 #if defined(_WIN32)
 static constexpr char FONT_ROOT[] = "c:/WINDOWS/Fonts";  // for debug only
@@ -43,6 +44,8 @@ namespace text_subtitles
 {
 FT_Library TextSubtitlesRenderFT::library;
 std::map<std::string, std::string> TextSubtitlesRenderFT::m_fontNameToFile;
+// files may be probed in parallel: guards the library init and the face creation, which FreeType does not serialize
+static std::mutex libraryMtx;
 
 constexpr double PI = 3.1415926f;
 constexpr double angle = -PI / 10.0f;
@@ -59,6 +62,7 @@ uint32_t convertColor(uint32_t color)
 TextSubtitlesRenderFT::TextSubtitlesRenderFT() : TextSubtitlesRender()
 {
     static bool initialized = false;
+    std::lock_guard lock(libraryMtx);
     if (!initialized)
     {
         int error = FT_Init_FreeType(&library);
@@ -202,6 +206,7 @@ int TextSubtitlesRenderFT::loadFont(const string& fontName, FT_Face& face)
     const auto itr = m_fontMap.find(fontName);
     if (itr == m_fontMap.end())
     {
+        std::lock_guard lock(libraryMtx);
         const int error = FT_New_Face(library, fontName.c_str(), 0, &face);
         if (error)
             return error;
@@ -0,0 +1,151 @@
+#include "outputSink.h"
+
+#include <types/types.h>
+
+#include <cstring>
+
+#include "crc32.h"
+#include "vodCoreException.h"
+#include "vod_common.h"
+
+OutputSinkType outputSinkTypeFromString(const std::string& name)
+{
+    const std::string str = strToLowerCase(name);
+    if (str == "discard" || str == "null")
+        return OutputSinkType::Discard;
+    if (str == "memory")
+        return OutputSinkType::Memory;
+    if (str == "hash")
+        return OutputSinkType::Hash;
+    THROW(ERR_COMMON, "Unknown output sink " << name << ". Expected discard, memory or hash")
+}
+
+SinkOutputStream::SinkOutputStream(OutputSinkFactory* owner, const OutputSinkType type, const bool keepData)
+    : m_owner(owner),
+      m_type(type),
+      m_keepData(type == OutputSinkType::Memory || (keepData && type == OutputSinkType::Hash)),
+      m_size(0),
+      m_pos(0),
+      m_crc(0),
+      m_opened(false)
+{
+}
+
+SinkOutputStream::~SinkOutputStream() { SinkOutputStream::close(); }
+
+bool SinkOutputStream::open(const char* fName, const unsigned int oflag, unsigned int)
+{
+    close();
+    m_name = fName;
+    m_size = 0;
+    m_crc = 0;
+    m_data.clear();
+    if (oflag & ofAppend)
+    {
+        OutputSinkFactory::FileInfo info = m_owner->takeFile(m_name);
+        m_size = info.size;
+        m_crc = info.crc;
+        m_data = std::move(info.data);
+    }
+    m_pos = m_size;
+    m_opened = true;
+    return true;
+}
+
+bool SinkOutputStream::close()
+{
+    if (m_opened)
+    {
+        OutputSinkFactory::FileInfo info;
+        info.size = m_size;
+        info.crc = m_crc;
+        if (m_type == OutputSinkType::Hash && m_keepData)
+            info.crc = calculateCRC32(m_data.data(), m_data.size());
+        else
+            info.data = std::move(m_data);
+        m_owner->storeFile(m_name, std::move(info));
+        m_data.clear();
+        m_opened = false;
+    }
+    return true;
+}
+
+int SinkOutputStream::write(const void* buffer, const uint32_t count)
+{
+    const auto data = static_cast<const uint8_t*>(buffer);
+    if (m_keepData)
+    {
+        if (m_pos + count > static_cast<int64_t>(m_data.size()))
+            m_data.resize(m_pos + count);
+        memcpy(m_data.data() + m_pos, data, count);
+    }
+    else if (m_type == OutputSinkType::Hash && count > 0)
+        m_crc = calculateCRC32(data, count, m_size > 0 ? m_crc : 0);
+    m_pos += count;
+    m_size = FFMAX(m_size, m_pos);
+    return static_cast<int>(count);
+}
+
+int64_t SinkOutputStream::seek(const int64_t offset, const SeekMethod whence) const
+{
+    int64_t newPos = offset;
+    if (whence == SeekMethod::smCurrent)
+        newPos += m_pos;
+    else if (whence == SeekMethod::smEnd)
+        newPos += m_size;
+    // a hashed stream is only written sequentially unless it keeps its data
+    if (newPos < 0 || (!m_keepData && m_type == OutputSinkType::Hash && newPos != m_size))
+        return static_cast<int64_t>(-1);
+    m_pos = newPos;
+    return m_pos;
+}
+
+AbstractOutputStream* OutputSinkFactory::createFile() { return new SinkOutputStream(this, m_type); }
+
+SinkOutputStream* OutputSinkFactory::createSeekableFile() { return new SinkOutputStream(this, m_type, true); }
+
+std::map<std::string, int64_t> OutputSinkFactory::getFileSizes() const
+{
+    std::lock_guard<std::mutex> lk(m_mtx);
+    std::map<std::string, int64_t> rez;
+    for (const auto& [fileName, info] : m_files) rez[fileName] = info.size;
+    return rez;
+}
+
+int64_t OutputSinkFactory::getFileSize(const std::string& fileName) const
+{
+    std::lock_guard<std::mutex> lk(m_mtx);
+    const auto itr = m_files.find(fileName);
+    return itr != m_files.end() ? itr->second.size : 0;
+}
+
+uint32_t OutputSinkFactory::getFileHash(const std::string& fileName) const
+{
+    std::lock_guard<std::mutex> lk(m_mtx);
+    const auto itr = m_files.find(fileName);
+    return itr != m_files.end() ? itr->second.crc : 0;
+}
+
+std::vector<uint8_t> OutputSinkFactory::getFileData(const std::string& fileName) const
+{
+    std::lock_guard<std::mutex> lk(m_mtx);
+    const auto itr = m_files.find(fileName);
+    return itr != m_files.end() ? itr->second.data : std::vector<uint8_t>();
+}
+
+void OutputSinkFactory::storeFile(const std::string& fileName, FileInfo&& info)
+{
+    std::lock_guard<std::mutex> lk(m_mtx);
+    m_files[fileName] = std::move(info);
+}
+
+OutputSinkFactory::FileInfo OutputSinkFactory::takeFile(const std::string& fileName)
+{
+    std::lock_guard<std::mutex> lk(m_mtx);
+    const auto itr = m_files.find(fileName);
+    if (itr == m_files.end())
+        return {};
+    FileInfo rez = std::move(itr->second);
+    m_files.erase(itr);
+    return rez;
+}
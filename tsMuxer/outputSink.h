@@ -0,0 +1,91 @@
+#ifndef OUTPUT_SINK_H_
+#define OUTPUT_SINK_H_
+
+#include <fs/file.h>
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+enum class OutputSinkType
+{
+    None,     // regular files
+    Discard,  // only the size of the data is tracked
+    Memory,   // data is kept in memory
+    Hash      // CRC32 of the data is computed
+};
+
+OutputSinkType outputSinkTypeFromString(const std::string& name);
+
+class OutputSinkFactory;
+
+// Output stream which does not touch the file system. The result is stored in the owner factory on close.
+// A stream created with keepData (see OutputSinkFactory::createSeekableFile) keeps its data in hash mode too, so
+// that it can be rewritten after a seek, and hashes it on close.
+class SinkOutputStream final : public AbstractSeekableOutputStream
+{
+   public:
+    SinkOutputStream(OutputSinkFactory* owner, OutputSinkType type, bool keepData = false);
+    ~SinkOutputStream() override;
+
+    bool open(const char* fName, unsigned int oflag, unsigned int systemDependentFlags = 0) override;
+    bool close() override;
+    [[nodiscard]] int64_t size() const override { return m_size; }
+    int write(const void* buffer, uint32_t count) override;
+    void sync() override {}
+    int64_t seek(int64_t offset, SeekMethod whence = SeekMethod::smBegin) const override;
+    [[nodiscard]] uint64_t pos() const override { return m_pos; }
+
+   private:
+    OutputSinkFactory* m_owner;
+    OutputSinkType m_type;
+    bool m_keepData;
+    std::string m_name;
+    int64_t m_size;
+    mutable int64_t m_pos;
+    uint32_t m_crc;
+    std::vector<uint8_t> m_data;
+    bool m_opened;
+};
+
+// File factory for the output sinks (--dry-run, --output-sink). It keeps the resulting size of every file, and the
+// data or the hash depending on the sink type. May be used directly by benchmark code: MuxerManager::doMux(name,
+// &factory)
+class OutputSinkFactory final : public FileFactory
+{
+   public:
+    explicit OutputSinkFactory(OutputSinkType type = OutputSinkType::Discard) : m_type(type) {}
+
+    AbstractOutputStream* createFile() override;
+    // for the ISO image, which is updated in place. In hash mode its data is kept in memory until it is closed
+    SinkOutputStream* createSeekableFile();
+    [[nodiscard]] bool isVirtualFS() const override { return false; }
+
+    [[nodiscard]] OutputSinkType getType() const { return m_type; }
+    void setType(const OutputSinkType type) { m_type = type; }
+
+    [[nodiscard]] std::map<std::string, int64_t> getFileSizes() const;
+    [[nodiscard]] int64_t getFileSize(const std::string& fileName) const;
+    [[nodiscard]] uint32_t getFileHash(const std::string& fileName) const;              // Hash mode only
+    [[nodiscard]] std::vector<uint8_t> getFileData(const std::string& fileName) const;  // Memory mode only
+
+   private:
+    friend class SinkOutputStream;
+
+    struct FileInfo
+    {
+        int64_t size = 0;
+        uint32_t crc = 0;
+        std::vector<uint8_t> data;
+    };
+
+    void storeFile(const std::string& fileName, FileInfo&& info);
+    FileInfo takeFile(const std::string& fileName);
+
+    OutputSinkType m_type;
+    mutable std::mutex m_mtx;  // streams are closed by the writer thread
+    std::map<std::string, FileInfo> m_files;
+};
+
+#endif
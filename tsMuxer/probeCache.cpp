@@ -0,0 +1,198 @@
+#include "probeCache.h"
+
+#include <fs/file.h>
+#include <types/types.h>
+
+// the results of another tsMuxeR version may differ, so its cache is dropped as a whole
+static constexpr char PROBE_CACHE_HEADER[] = "tsMuxeR probe cache 2 " TSMUXER_VERSION;
+static constexpr size_t MAX_PROBE_CACHE_ENTRIES = 1000;
+
+namespace
+{
+// fields are separated by tabs and records by new lines, so both are escaped inside the strings
+std::string escapeField(const std::string& str)
+{
+    std::string rez;
+    for (const char c : str)
+    {
+        if (c == '\\')
+            rez += "\\\\";
+        else if (c == '\t')
+            rez += "\\t";
+        else if (c == '\n')
+            rez += "\\n";
+        else if (c == '\r')
+            rez += "\\r";
+        else
+            rez += c;
+    }
+    return rez;
+}
+
+std::string unescapeField(const std::string& str)
+{
+    std::string rez;
+    for (size_t i = 0; i < str.size(); i++)
+    {
+        if (str[i] == '\\' && i + 1 < str.size())
+        {
+            const char c = str[++i];
+            rez += c == 't' ? '\t' : c == 'n' ? '\n' : c == 'r' ? '\r' : c;
+        }
+        else
+            rez += str[i];
+    }
+    return rez;
+}
+}  // namespace
+
+ProbeCache::ProbeCache(const std::string& cacheFileName) : m_cacheFileName(cacheFileName), m_modified(false)
+{
+    load();
+}
+
+void ProbeCache::load()
+{
+    File file;
+    if (!file.open(m_cacheFileName.c_str(), File::ofRead | File::ofOpenExisting))
+        return;
+    const int64_t fileSize = file.size();
+    if (fileSize <= 0)
+        return;
+    std::string data(static_cast<size_t>(fileSize), '\0');
+    if (file.read(data.data(), static_cast<uint32_t>(fileSize)) != fileSize)
+        return;
+
+    // every entry starts with its file line which gives the number of its track and chapter lines. An entry with
+    // missing or malformed lines (e.g. the cache was not written completely) is dropped.
+    std::vector<std::string> lines = splitStr(data, "\n");
+    if (lines.empty() || lines[0] != PROBE_CACHE_HEADER)
+        return;
+    Entry entry;
+    size_t trackCnt = 0;
+    size_t chapterCnt = 0;
+    bool entryValid = false;
+    for (size_t i = 1; i < lines.size(); i++)
+    {
+        const std::vector<std::string> fields = splitStr(lines[i], "\t");
+        if (fields.empty())
+            continue;
+        if (fields[0] == "F" && fields.size() == 11)
+        {
+            entry = Entry();
+            entry.fileName = unescapeField(fields[1]);
+            entry.identity.file.size = strToInt64u(fields[2].c_str());
+            entry.identity.file.modTime = strToInt64(fields[3].c_str());
+            entry.identity.file.inode = strToInt64u(fields[4].c_str());
+            entry.identity.clpi.size = strToInt64u(fields[5].c_str());
+            entry.identity.clpi.modTime = strToInt64(fields[6].c_str());
+            entry.identity.clpi.inode = strToInt64u(fields[7].c_str());
+            entry.rez.fileDurationNano = strToInt64(fields[8].c_str());
+            trackCnt = strToInt32u(fields[9].c_str());
+            chapterCnt = strToInt32u(fields[10].c_str());
+            entryValid = true;
+        }
+        else if (fields[0] == "T" && fields.size() == 11 && entryValid)
+        {
+            CheckStreamRez track;
+            track.trackID = strToInt32(fields[1]);
+            track.codecInfo.codecID = strToInt32(fields[2]);
+            track.codecInfo.displayName = unescapeField(fields[3]);
+            track.codecInfo.programName = unescapeField(fields[4]);
+            track.streamDescr = unescapeField(fields[5]);
+            track.lang = unescapeField(fields[6]);
+            track.delay = strToInt64(fields[7].c_str());
+            track.multiSubStream = fields[8] == "1";
+            track.isSecondary = fields[9] == "1";
+            track.unused = fields[10] == "1";
+            entry.rez.streams.push_back(track);
+        }
+        else if (fields[0] == "C" && fields.size() == 3 && entryValid)
+            entry.rez.chapters.emplace_back(strToInt64(fields[1].c_str()), unescapeField(fields[2]));
+        else
+            entryValid = false;
+
+        if (entryValid && entry.rez.streams.size() == trackCnt && entry.rez.chapters.size() == chapterCnt)
+        {
+            m_entries.push_back(entry);
+            entryValid = false;
+        }
+    }
+}
+
+bool ProbeCache::getIdentity(const std::string& fileName, Identity& identity)
+{
+    if (!getFileIdentity(fileName, identity.file))
+        return false;
+    const std::string clpiFileName = METADemuxer::findClpiFile(fileName);
+    return clpiFileName.empty() || getFileIdentity(clpiFileName, identity.clpi);
+}
+
+bool ProbeCache::find(const std::string& fileName, DetectStreamRez& rez)
+{
+    Identity identity;
+    if (!getIdentity(fileName, identity))
+        return false;
+    for (const auto& entry : m_entries)
+    {
+        if (entry.fileName == fileName && entry.identity == identity)
+        {
+            rez = entry.rez;
+            return true;
+        }
+    }
+    m_missed[fileName] = identity;
+    return false;
+}
+
+void ProbeCache::store(const std::string& fileName, const DetectStreamRez& rez)
+{
+    // the identity is taken before probing, a file changed meanwhile is probed again next time
+    const auto itr = m_missed.find(fileName);
+    if (itr == m_missed.end() || rez.error)
+        return;
+    for (auto entry = m_entries.begin(); entry != m_entries.end();)
+    {
+        if (entry->fileName == fileName)
+            entry = m_entries.erase(entry);
+        else
+            ++entry;
+    }
+    m_entries.push_back(Entry{fileName, itr->second, rez});
+    if (m_entries.size() > MAX_PROBE_CACHE_ENTRIES)
+        m_entries.erase(m_entries.begin());
+    m_missed.erase(itr);
+    m_modified = true;
+}
+
+void ProbeCache::save() const
+{
+    if (!m_modified)
+        return;
+    std::string data = PROBE_CACHE_HEADER;
+    data += '\n';
+    for (const auto& entry : m_entries)
+    {
+        const DetectStreamRez& rez = entry.rez;
+        const Identity& identity = entry.identity;
+        data += "F\t" + escapeField(entry.fileName) + '\t' + int64uToStr(identity.file.size) + '\t' +
+                int64ToStr(identity.file.modTime) + '\t' + int64uToStr(identity.file.inode) + '\t' +
+                int64uToStr(identity.clpi.size) + '\t' + int64ToStr(identity.clpi.modTime) + '\t' +
+                int64uToStr(identity.clpi.inode) + '\t' + int64ToStr(rez.fileDurationNano) + '\t' +
+                int64uToStr(rez.streams.size()) + '\t' + int64uToStr(rez.chapters.size()) + '\n';
+        for (const auto& track : rez.streams)
+        {
+            data += "T\t" + int32ToStr(track.trackID) + '\t' + int32ToStr(track.codecInfo.codecID) + '\t' +
+                    escapeField(track.codecInfo.displayName) + '\t' + escapeField(track.codecInfo.programName) +
+                    '\t' + escapeField(track.streamDescr) + '\t' + escapeField(track.lang) + '\t' +
+                    int64ToStr(track.delay) + '\t' + (track.multiSubStream ? '1' : '0') + '\t' +
+                    (track.isSecondary ? '1' : '0') + '\t' + (track.unused ? '1' : '0') + '\n';
+        }
+        for (const auto& chapter : rez.chapters)
+            data += "C\t" + int64ToStr(chapter.start) + '\t' + escapeField(chapter.cTitle) + '\n';
+    }
+    // the cache only saves time, a cache file which can't be written is not an error
+    File file;
+    if (file.open(m_cacheFileName.c_str(), File::ofWrite))
+        file.write(data.data(), static_cast<uint32_t>(data.size()));
+}
@@ -0,0 +1,50 @@
+#ifndef PROBE_CACHE_H_
+#define PROBE_CACHE_H_
+
+#include <fs/directory.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "metaDemuxer.h"
+
+// Track detection results kept in a file between runs. A result is only used while the size, modification time
+// and inode of the probed file, and of the clip info file of a Blu-ray stream, are the same as when it was stored,
+// by the same tsMuxeR version.
+class ProbeCache
+{
+   public:
+    explicit ProbeCache(const std::string& cacheFileName);
+
+    // returns the stored result of an unchanged file
+    bool find(const std::string& fileName, DetectStreamRez& rez);
+    // stores the result of a file passed to find() before probing it
+    void store(const std::string& fileName, const DetectStreamRez& rez);
+    void save() const;
+
+   private:
+    struct Identity
+    {
+        bool operator==(const Identity& other) const { return file == other.file && clpi == other.clpi; }
+        FileIdentity file;
+        FileIdentity clpi;  // all 0 without a clip info file
+    };
+
+    struct Entry
+    {
+        std::string fileName;
+        Identity identity;
+        DetectStreamRez rez;
+    };
+
+    void load();
+    static bool getIdentity(const std::string& fileName, Identity& identity);
+
+    std::string m_cacheFileName;
+    std::vector<Entry> m_entries;  // the oldest first
+    std::map<std::string, Identity> m_missed;
+    bool m_modified;
+};
+
+#endif
@@ -12,7 +12,7 @@ static constexpr int LPCM_FREQS[4] = {48000, 96000, 44100, 32000};
 // #define min(a,b) a<=b?a:b
 
 ProgramStreamDemuxer::ProgramStreamDemuxer(const BufferedReaderManager& readManager)
-    : m_tmpBuffer{}, m_readManager(readManager), m_dataProcessed(0)
+    : m_carry(MAX_PES_HEADER_SIZE), m_readManager(readManager), m_dataProcessed(0)
 {
     memset(m_psm_es_type, 0, sizeof(m_psm_es_type));
     memset(m_lpcpHeaderAdded, 0, sizeof(m_lpcpHeaderAdded));
@@ -21,7 +21,6 @@ ProgramStreamDemuxer::ProgramStreamDemuxer(const BufferedReaderManager& readMana
     m_lastReadRez = 0;
     m_lastPesLen = 0;
     m_lastPID = 0;
-    m_tmpBufferLen = 0;
     m_firstPTS = -1;
     m_firstVideoPTS = -1;
 }
@@ -205,7 +204,7 @@ int ProgramStreamDemuxer::simpleDemuxBlock(DemuxedData& demuxedData, const PIDSe
         m_lastReadRez = readRez;
         return BufferedFileReader::DATA_NOT_READY;
     }
-    if (readedBytes + m_tmpBufferLen == 0 || (readedBytes == 0 && m_lastReadRez == BufferedReader::DATA_EOF))
+    if (readedBytes + m_carry.size() == 0 || (readedBytes == 0 && m_lastReadRez == BufferedReader::DATA_EOF))
     {
         m_lastReadRez = readRez;
         return BufferedReader::DATA_EOF;
@@ -215,14 +214,8 @@ int ProgramStreamDemuxer::simpleDemuxBlock(DemuxedData& demuxedData, const PIDSe
 
     m_lastReadRez = readRez;
     data += MAX_PES_HEADER_SIZE;
-    assert(m_tmpBufferLen <= MAX_PES_HEADER_SIZE);
-    if (m_tmpBufferLen > 0)
-    {
-        memcpy(data - m_tmpBufferLen, m_tmpBuffer, m_tmpBufferLen);
-        data -= m_tmpBufferLen;
-        readedBytes += m_tmpBufferLen;
-        m_tmpBufferLen = 0;
-    }
+    readedBytes += m_carry.size();
+    data = m_carry.restore(data);
 
     uint8_t* end = data + readedBytes;
     uint8_t* curBuf = data;
@@ -252,6 +245,9 @@ int ProgramStreamDemuxer::simpleDemuxBlock(DemuxedData& demuxedData, const PIDSe
     curBuf = MPEGHeader::findNextMarker(curBuf, end);
     discardSize += curBuf - prevBuf;
 
+    // PES packets of a stream usually follow each other, look up the stream once per run
+    int curStream = -1;
+    StreamData* curVect = nullptr;
     while (curBuf <= end - 9)
     {
         const auto pesPacket = reinterpret_cast<PESPacket*>(curBuf);
@@ -263,7 +259,12 @@ int ProgramStreamDemuxer::simpleDemuxBlock(DemuxedData& demuxedData, const PIDSe
                 break;
             int afterPesHeader = 0;
             startcode = processPES(curBuf, end, afterPesHeader);
-            if (acceptedPIDs.find(startcode) != acceptedPIDs.end())
+            if (startcode != curStream)
+            {
+                curStream = startcode;
+                curVect = acceptedPIDs.count(startcode) ? &demuxedData[startcode] : nullptr;
+            }
+            if (curVect)
             {
                 if ((pesPacket->flagsLo & 0x80) == 0x80)
                 {
@@ -276,7 +277,7 @@ int ProgramStreamDemuxer::simpleDemuxBlock(DemuxedData& demuxedData, const PIDSe
                         m_firstPtsTime[startcode] = curPts;
                 }
 
-                StreamData& vect = demuxedData[startcode];
+                StreamData& vect = *curVect;
 
                 const int idx = startcode - 0xa0;
                 if (idx >= 0 && idx <= 15 && !m_lpcpHeaderAdded[idx])
@@ -342,9 +343,7 @@ int ProgramStreamDemuxer::simpleDemuxBlock(DemuxedData& demuxedData, const PIDSe
         curBuf = MPEGHeader::findNextMarker(curBuf, end);
         discardSize += curBuf - prevBuf;
     }
-    m_tmpBufferLen = static_cast<uint32_t>(end - curBuf);
-    if (m_tmpBufferLen > 0)
-        memmove(m_tmpBuffer, curBuf, end - curBuf);
+    m_carry.store(curBuf, static_cast<uint32_t>(end - curBuf), m_bufferedReader->isContiguous(m_readerID));
     return 0;
 }
 
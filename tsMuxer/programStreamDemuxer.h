@@ -36,8 +36,7 @@ class ProgramStreamDemuxer final : public AbstractDemuxer
     [[nodiscard]] int64_t getFileDurationNano() const override;
 
    private:
-    uint32_t m_tmpBufferLen;
-    uint8_t m_tmpBuffer[MAX_PES_HEADER_SIZE];  // TS_FRAME_SIZE
+    BlockCarry m_carry;
     uint32_t m_lastPesLen;
     int32_t m_lastPID;
     const BufferedReaderManager& m_readManager;
@@ -2,12 +2,19 @@
 
 #include <fs/systemlog.h>
 
+#include <algorithm>
+
 #include "abstractStreamReader.h"
+#include "nalUnits.h"
 #include "vodCoreException.h"
 #include "vod_common.h"
 
 using namespace std;
 
+static constexpr int M2TS_FRAME_SIZE = TS_FRAME_SIZE + 4;
+static constexpr int SEEK_SCAN_SIZE = 4 * 1024 * 1024;  // read after a seek position to find the PES of each pid
+static constexpr int MAX_SEEK_WINDOWS = 16;             // windows searched back for a random access picture
+
 bool isM2TSExt(const std::string& streamName)
 {
     const string sName = strToLowerCase(unquoteStr(streamName));
@@ -22,7 +29,7 @@ TSDemuxer::TSDemuxer(const BufferedReaderManager& readManager, const char* strea
       m_readCnt(0),
       m_dataProcessed(0),
       m_notificated(false),
-      m_tmpBuffer{}
+      m_carry(TS_FRAME_SIZE)
 {
     m_firstPCRTime = -1;
     m_bufferedReader = m_readManager.getReader(streamName);
@@ -32,7 +39,6 @@ TSDemuxer::TSDemuxer(const BufferedReaderManager& readManager, const char* strea
               "TS demuxer can't accept reader because this reader does not support BufferedReader interface")
     m_scale = 1;
     m_nptPos = 0;
-    m_tmpBufferLen = 0;
     m_m2tsMode = false;
     m_lastReadRez = 0;
     m_m2tsHdrDiscarded = false;
@@ -48,16 +54,22 @@ TSDemuxer::TSDemuxer(const BufferedReaderManager& readManager, const char* strea
     m_lastPCRVal = -1;
     m_nonMVCVideoFound = false;
     m_firstDemuxCall = true;
+    m_entryPointPID = 0;
+    m_skippedSize = 0;
+    m_waitPesStart = false;
     memset(m_acceptedPidCache, 0, sizeof(m_acceptedPidCache));
 }
 
 bool TSDemuxer::mvcContinueExpected() const { return !m_nonMVCVideoFound && strEndWith(m_streamNameLow, "ssif"); }
 
-void TSDemuxer::getTrackList(std::map<int32_t, TrackInfo>& trackList)
+void TSDemuxer::getTrackList(std::map<int32_t, TrackInfo>& trackList) { loadPmt(&trackList); }
+
+void TSDemuxer::loadPmt(std::map<int32_t, TrackInfo>* trackList)
 {
     uint8_t pmtBuffer[4096]{0};
     int pmtBufferLen = 0;
-    uint32_t tmpBufferLen = 0;
+    BlockCarry carry(TS_FRAME_SIZE);
+    const bool contiguous = m_bufferedReader->isContiguous(m_readerID);
     uint32_t readedBytes;
     uint32_t totalReadedBytes = 0;
     m_lastReadRez = 0;
@@ -73,13 +85,8 @@ void TSDemuxer::getTrackList(std::map<int32_t, TrackInfo>& trackList)
         uint8_t* data = m_bufferedReader->readBlock(m_readerID, readedBytes, lastReadRez);
         totalReadedBytes += readedBytes;
         data += TS_FRAME_SIZE;
-        if (tmpBufferLen > 0)
-        {
-            memcpy(data - tmpBufferLen, m_tmpBuffer, tmpBufferLen);
-            data -= tmpBufferLen;
-            readedBytes += tmpBufferLen;
-            tmpBufferLen = 0;
-        }
+        readedBytes += carry.size();
+        data = carry.restore(data);
         uint8_t* lastFrameAddr = data + readedBytes - TS_FRAME_SIZE;
         TS_program_association_section pat;
 
@@ -132,9 +139,10 @@ void TSDemuxer::getTrackList(std::map<int32_t, TrackInfo>& trackList)
                         if (m_pmt.video_type != static_cast<int>(StreamType::VIDEO_MVC))
                             m_nonMVCVideoFound = true;
                         pmtBufferLen = 0;
-                        for (const auto& [fst, snd] : m_pmt.pidList)
-                            trackList.insert(std::make_pair(
-                                snd.m_pid, TrackInfo(static_cast<int>(snd.m_streamType), snd.m_lang, 0)));
+                        if (trackList)
+                            for (const auto& [fst, snd] : m_pmt.pidList)
+                                trackList->insert(std::make_pair(
+                                    snd.m_pid, TrackInfo(static_cast<int>(snd.m_streamType), snd.m_lang, 0)));
                         nonProcPMTPid.erase(pid);
                         if (nonProcPMTPid.empty() && !mvcContinueExpected())
                         {  // all pmt pids processed
@@ -142,7 +150,7 @@ void TSDemuxer::getTrackList(std::map<int32_t, TrackInfo>& trackList)
                             if (br)
                                 br->incSeek(m_readerID, -static_cast<int64_t>(totalReadedBytes));
                             else
-                                THROW(ERR_COMMON, "Function TSDemuxer::getTrackList required bufferedReader!")
+                                THROW(ERR_COMMON, "Function TSDemuxer::loadPmt required bufferedReader!")
                             return;
                         }
                     }
@@ -150,17 +158,14 @@ void TSDemuxer::getTrackList(std::map<int32_t, TrackInfo>& trackList)
             }
         }
         if (curPos < data + readedBytes)
-        {
-            tmpBufferLen = static_cast<uint32_t>(data + readedBytes - curPos);
-            memmove(m_tmpBuffer, curPos, tmpBufferLen);
-        }
+            carry.store(curPos, static_cast<uint32_t>(data + readedBytes - curPos), contiguous);
     }
 
     auto br = dynamic_cast<BufferedFileReader*>(m_bufferedReader);
     if (br)
         br->incSeek(m_readerID, -static_cast<int64_t>(totalReadedBytes));
     else
-        THROW(ERR_COMMON, "Function TSDemuxer::getTrackList required bufferedReader!")
+        THROW(ERR_COMMON, "Function TSDemuxer::loadPmt required bufferedReader!")
 }
 
 bool TSDemuxer::isVideoPID(const StreamType streamType)
@@ -202,14 +207,12 @@ int TSDemuxer::simpleDemuxBlock(DemuxedData& demuxedData, const PIDSet& accepted
 {
     if (m_firstDemuxCall)
     {
-        for (const int acceptedPID : acceptedPIDs) m_acceptedPidCache[acceptedPID] = 1;
+        for (const int acceptedPID : acceptedPIDs) m_acceptedPidCache[acceptedPID] = m_waitPesStart ? 2 : 1;
         m_firstDemuxCall = false;
     }
 
     uint8_t pmtBuffer[4096]{0};
     int pmtBufferLen = 0;
-    MemoryBlock* vect = nullptr;
-    int lastPid = -1;
 
     for (int acceptedPID : acceptedPIDs) demuxedData[acceptedPID];
 
@@ -223,7 +226,7 @@ int TSDemuxer::simpleDemuxBlock(DemuxedData& demuxedData, const PIDSet& accepted
         m_lastReadRez = readRez;
         return BufferedFileReader::DATA_NOT_READY;
     }
-    if (readedBytes + m_tmpBufferLen == 0 || (readedBytes == 0 && m_lastReadRez == BufferedReader::DATA_EOF))
+    if (readedBytes + m_carry.size() == 0 || (readedBytes == 0 && m_lastReadRez == BufferedReader::DATA_EOF))
     {
         m_lastReadRez = readRez;
         return BufferedReader::DATA_EOF;
@@ -232,13 +235,8 @@ int TSDemuxer::simpleDemuxBlock(DemuxedData& demuxedData, const PIDSet& accepted
         m_bufferedReader->notify(m_readerID, readedBytes);
     m_lastReadRez = readRez;
     data += TS_FRAME_SIZE;
-    if (m_tmpBufferLen > 0)
-    {
-        memcpy(data - m_tmpBufferLen, m_tmpBuffer, m_tmpBufferLen);
-        data -= m_tmpBufferLen;
-        readedBytes += static_cast<uint32_t>(m_tmpBufferLen);
-        m_tmpBufferLen = 0;
-    }
+    readedBytes += m_carry.size();
+    data = m_carry.restore(data);
 
     if (isFirstBlock)
     {
@@ -260,7 +258,8 @@ int TSDemuxer::simpleDemuxBlock(DemuxedData& demuxedData, const PIDSet& accepted
         m_curFileNum++;
     }
 
-    discardSize = 0;
+    discardSize = m_skippedSize;
+    m_skippedSize = 0;
 
     if (readedBytes < TS_FRAME_SIZE)
     {
@@ -321,7 +320,12 @@ int TSDemuxer::simpleDemuxBlock(DemuxedData& demuxedData, const PIDSet& accepted
         }
     }
 
-    for (m_curPos = data; m_curPos <= lastFrameAddr; m_curPos += TS_FRAME_SIZE)
+    // pre-pass: validate sync bytes and classify the packets of the block by PID
+    const int m2tsHdrSize = m_m2tsMode ? 4 : 0;
+    m_packetOffsets.clear();
+    m_packetPids.clear();
+    m_curPos = data;
+    while (m_curPos <= lastFrameAddr)
     {
         if (!m_m2tsHdrDiscarded && m_m2tsMode)
         {
@@ -340,111 +344,359 @@ int TSDemuxer::simpleDemuxBlock(DemuxedData& demuxedData, const PIDSet& accepted
         }
         m_m2tsHdrDiscarded = false;
 
-        const auto tsPacket = reinterpret_cast<TSPacket*>(m_curPos);
-        int pid = tsPacket->getPID();
-        discardSize += TS_FRAME_SIZE;
-
-        // pcrFrames++;
+        // packets are in sync. Check the next sync byte only, resync is done above
+        while (true)
+        {
+            m_packetOffsets.push_back(static_cast<uint32_t>(m_curPos - data));
+            m_packetPids.push_back(static_cast<uint16_t>(reinterpret_cast<TSPacket*>(m_curPos)->getPID()));
+            discardSize += TS_FRAME_SIZE;
+            m_curPos += TS_FRAME_SIZE;
+            if (m_curPos + m2tsHdrSize > lastFrameAddr || m_curPos[m2tsHdrSize] != 0x47)
+                break;
+            m_curPos += m2tsHdrSize;
+            discardSize += m2tsHdrSize;
+        }
+    }
 
-        if (tsPacket->afExists)
+    const size_t packetCnt = m_packetPids.size();
+    for (size_t runStart = 0; runStart < packetCnt;)
+    {
+        // process a run of packets with the same PID
+        const int pid = m_packetPids[runStart];
+        size_t runEnd = runStart + 1;
+        while (runEnd < packetCnt && m_packetPids[runEnd] == pid) runEnd++;
+        int64_t runPayloadLen = 0;
+        m_runPayload.clear();
+
+        for (size_t i = runStart; i < runEnd; ++i)
         {
-            if (tsPacket->adaptiveField.pcrExist)
+            uint8_t* curPos = data + m_packetOffsets[i];
+            const auto tsPacket = reinterpret_cast<TSPacket*>(curPos);
+            uint8_t* frameData = curPos + tsPacket->getHeaderSize();
+            const bool pesStartCode =
+                frameData[0] == 0 && frameData[1] == 0 && frameData[2] == 1 && tsPacket->payloadStart;
+            if (pesStartCode)
             {
-                // if (prevPCR == -1)
-                //	prevPCR = tsPacket->adaptiveField.getPCR33();
+                const auto pesPacket = reinterpret_cast<PESPacket*>(frameData);
+                auto streamInfo = m_pmt.pidList.find(pid);
 
-                // prevPCR = tsPacket->adaptiveField.getPCR33();
-                // LTRACE(LT_INFO, 2, "pcr: " << prevPCR - 55729419ll);
-                // pcrFrames = 0;
-            }
-        }
+                if ((pesPacket->flagsLo & 0x80) == 0x80)
+                {
+                    const int64_t curPts = pesPacket->getPts();
+                    int64_t curDts = curPts;
 
-        uint8_t* frameData = m_curPos + tsPacket->getHeaderSize();
-        const bool pesStartCode = frameData[0] == 0 && frameData[1] == 0 && frameData[2] == 1 && tsPacket->payloadStart;
-        if (pesStartCode)
-        {
-            const auto pesPacket = reinterpret_cast<PESPacket*>(frameData);
-            auto streamInfo = m_pmt.pidList.find(pid);
+                    if ((pesPacket->flagsLo & 0xc0) == 0xc0)
+                        curDts = pesPacket->getDts();
 
-            if ((pesPacket->flagsLo & 0x80) == 0x80)
-            {
-                const int64_t curPts = pesPacket->getPts();
-                int64_t curDts = curPts;
+                    if (m_lastPTS == -1 || curPts > m_lastPTS)
+                        m_lastPTS = curPts;
 
-                if ((pesPacket->flagsLo & 0xc0) == 0xc0)
-                    curDts = pesPacket->getDts();
+                    if (m_firstPTS == -1 || curPts < m_firstPTS)
+                        m_firstPTS = curPts;
 
-                if (m_lastPTS == -1 || curPts > m_lastPTS)
-                    m_lastPTS = curPts;
+                    if (streamInfo != m_pmt.pidList.end() && isVideoPID(streamInfo->second.m_streamType))
+                    {
+                        if (m_firstVideoPTS == -1 || curPts < m_firstVideoPTS)
+                            m_firstVideoPTS = curPts;
+                        if (curPts > m_lastVideoPTS)
+                            m_lastVideoPTS = curPts;
+                        if (m_lastVideoDTS == -1)
+                            m_lastVideoDTS = curDts;
+                        if (m_videoDtsGap == -1 && curDts > m_lastVideoDTS)
+                            m_videoDtsGap = curDts - m_lastVideoDTS;
+                    }
 
-                if (m_firstPTS == -1 || curPts < m_firstPTS)
-                    m_firstPTS = curPts;
+                    if (m_firstPtsTime.find(pid) == m_firstPtsTime.end() ||
+                        (m_curFileNum == 0 && curPts < m_firstPtsTime[pid]))
+                        m_firstPtsTime[pid] = curPts;
+                }
 
-                if (streamInfo != m_pmt.pidList.end() && isVideoPID(streamInfo->second.m_streamType))
+                if (streamInfo != m_pmt.pidList.end() &&
+                    streamInfo->second.m_streamType != StreamType::SUB_PGS)  // demux PGS with PES headers
+                    frameData += pesPacket->getHeaderLength();
+                else
                 {
-                    if (m_firstVideoPTS == -1 || curPts < m_firstVideoPTS)
-                        m_firstVideoPTS = curPts;
-                    if (curPts > m_lastVideoPTS)
-                        m_lastVideoPTS = curPts;
-                    if (m_lastVideoDTS == -1)
-                        m_lastVideoDTS = curDts;
-                    if (m_videoDtsGap == -1 && curDts > m_lastVideoDTS)
-                        m_videoDtsGap = curDts - m_lastVideoDTS;
+                    const int64_t ptsBase = m_firstVideoPTS != -1 ? m_firstVideoPTS : m_firstPTS;
+                    if ((pesPacket->flagsLo & 0xc0) == 0xc0)
+                    {
+                        const int64_t pts = pesPacket->getPts() - ptsBase + m_prevFileLen;
+                        const int64_t dts = pesPacket->getDts() - ptsBase + m_prevFileLen;
+                        pesPacket->setPtsAndDts(pts, dts);
+                    }
+                    else if ((pesPacket->flagsLo & 0x80) == 0x80)
+                    {
+                        const int64_t pts = pesPacket->getPts() - ptsBase + m_prevFileLen;
+                        pesPacket->setPts(pts);
+                    }
                 }
+            }
 
-                if (m_firstPtsTime.find(pid) == m_firstPtsTime.end() ||
-                    (m_curFileNum == 0 && curPts < m_firstPtsTime[pid]))
-                    m_firstPtsTime[pid] = curPts;
+            if (m_acceptedPidCache[pid] != 1)
+            {
+                if (m_acceptedPidCache[pid] == 0 || !pesStartCode)
+                    continue;
+                m_acceptedPidCache[pid] = 1;
             }
 
-            if (streamInfo != m_pmt.pidList.end() &&
-                streamInfo->second.m_streamType != StreamType::SUB_PGS)  // demux PGS with PES headers
-                frameData += pesPacket->getHeaderLength();
-            else
+            const int64_t payloadLen = TS_FRAME_SIZE - (frameData - curPos);
+            if (payloadLen > 0)
+                m_runPayload.emplace_back(frameData, static_cast<int>(payloadLen));
+            runPayloadLen += payloadLen;
+        }
+
+        if (!m_runPayload.empty())
+        {
+            // single grow for the whole run
+            size_t copyLen = 0;
+            for (const auto& [frameData, payloadLen] : m_runPayload) copyLen += payloadLen;
+            MemoryBlock& vect = demuxedData[pid];
+            vect.grow(copyLen);
+            uint8_t* dst = vect.data() + vect.size() - copyLen;
+            for (const auto& [frameData, payloadLen] : m_runPayload)
             {
-                const int64_t ptsBase = m_firstVideoPTS != -1 ? m_firstVideoPTS : m_firstPTS;
-                if ((pesPacket->flagsLo & 0xc0) == 0xc0)
-                {
-                    const int64_t pts = pesPacket->getPts() - ptsBase + m_prevFileLen;
-                    const int64_t dts = pesPacket->getDts() - ptsBase + m_prevFileLen;
-                    pesPacket->setPtsAndDts(pts, dts);
-                }
-                else if ((pesPacket->flagsLo & 0x80) == 0x80)
+                memcpy(dst, frameData, payloadLen);
+                dst += payloadLen;
+            }
+        }
+        discardSize -= runPayloadLen;
+        runStart = runEnd;
+    }
+    if (m_curPos < data + readedBytes)
+        m_carry.store(m_curPos, static_cast<uint32_t>(data + readedBytes - m_curPos),
+                      m_bufferedReader->isContiguous(m_readerID));
+
+    return 0;
+}
+
+// true if the PES payload starts a picture which is decoded without the previous ones
+static bool isRandomAccessPes(TSPacket* tsPacket, const StreamType streamType, uint8_t* data, uint8_t* end)
+{
+    if (tsPacket->afExists && tsPacket->adaptiveField.length && tsPacket->adaptiveField.randomAccessIndicator)
+        return true;
+    for (uint8_t* nal = NALUnit::findNextNAL(data, end); nal < end - 2; nal = NALUnit::findNextNAL(nal, end))
+    {
+        switch (streamType)
+        {
+        case StreamType::VIDEO_MPEG1:
+        case StreamType::VIDEO_MPEG2:
+            // sequence header, GOP header or I picture
+            if (*nal == 0xb3 || *nal == 0xb8 || (*nal == 0 && ((nal[2] >> 3) & 7) == 1))
+                return true;
+            break;
+        case StreamType::VIDEO_H264:
+            if ((*nal & 0x1f) == 5 || (*nal & 0x1f) == 7)  // IDR, SPS
+                return true;
+            break;
+        case StreamType::VIDEO_H265:
+            if (((*nal >> 1) & 0x3f) >= 16 && ((*nal >> 1) & 0x3f) <= 23)  // IRAP
+                return true;
+            if (((*nal >> 1) & 0x3f) == 33)  // SPS
+                return true;
+            break;
+        case StreamType::VIDEO_H266:
+            if ((nal[1] >> 3) >= 7 && (nal[1] >> 3) <= 10)  // IDR, CRA, GDR
+                return true;
+            if ((nal[1] >> 3) == 15)  // SPS
+                return true;
+            break;
+        case StreamType::VIDEO_VC1:
+            if (*nal == 0x0f || *nal == 0x0e)  // sequence header, entry point
+                return true;
+            break;
+        default:
+            return false;
+        }
+    }
+    return false;
+}
+
+// Reads the PES headers of pids in the packets after offset, up to SEEK_SCAN_SIZE bytes. firstPts receives the PTS
+// of the first PES of each pid, the first random access picture for video unless randomAccessOnly is false.
+// keyFrames, if set, receives the PTS and position of the random access pictures of refPid.
+void TSDemuxer::scanPesHeaders(File& file, const int64_t offset, const PIDSet& pids, std::map<int, int64_t>& firstPts,
+                               const bool randomAccessOnly, const int refPid,
+                               std::vector<std::pair<int64_t, int64_t>>* keyFrames)
+{
+    firstPts.clear();
+    if (keyFrames)
+        keyFrames->clear();
+    const int frameSize = m_m2tsMode ? M2TS_FRAME_SIZE : TS_FRAME_SIZE;
+    const int hdrSize = frameSize - TS_FRAME_SIZE;
+    const int chunkSize = SEEK_SCAN_SIZE / 16 / frameSize * frameSize;
+    const auto buffer = new uint8_t[chunkSize];
+    int64_t chunkPos = offset;
+    int syncPos = -1;
+    while (chunkPos - offset < SEEK_SCAN_SIZE && (keyFrames || firstPts.size() < pids.size()))
+    {
+        if (static_cast<uint64_t>(file.seek(chunkPos, File::SeekMethod::smBegin)) == static_cast<uint64_t>(-1))
+            break;
+        const int len = file.read(buffer, chunkSize);
+        if (syncPos == -1)
+        {
+            // the packets start where two sync bytes in a row are found
+            for (int i = 0; i < frameSize && i + hdrSize + frameSize < len; i++)
+                if (buffer[i + hdrSize] == 0x47 && buffer[i + hdrSize + frameSize] == 0x47)
                 {
-                    const int64_t pts = pesPacket->getPts() - ptsBase + m_prevFileLen;
-                    pesPacket->setPts(pts);
+                    syncPos = i;
+                    break;
                 }
+            if (syncPos == -1)
+                break;
+            if (syncPos > 0)
+            {
+                chunkPos += syncPos;
+                continue;
             }
         }
+        for (int pos = 0; pos + frameSize <= len; pos += frameSize)
+        {
+            uint8_t* curPos = buffer + pos + hdrSize;
+            const auto tsPacket = reinterpret_cast<TSPacket*>(curPos);
+            if (*curPos != 0x47 || !tsPacket->payloadStart || tsPacket->getHeaderSize() + 14 > TS_FRAME_SIZE)
+                continue;
+            const int pid = tsPacket->getPID();
+            const auto pesPacket = reinterpret_cast<PESPacket*>(curPos + tsPacket->getHeaderSize());
+            if (!pids.count(pid) || pesPacket->startCode0 != 0 || pesPacket->startCode1 != 0 ||
+                pesPacket->startCode2 != 1 || !(pesPacket->flagsLo & 0x80))
+                continue;
+            const StreamType streamType = m_pmt.pidList[pid].m_streamType;
+            uint8_t* payload = reinterpret_cast<uint8_t*>(pesPacket) + pesPacket->getHeaderLength();
+            if (randomAccessOnly && isVideoPID(streamType) &&
+                (payload >= curPos + TS_FRAME_SIZE ||
+                 !isRandomAccessPes(tsPacket, streamType, payload, curPos + TS_FRAME_SIZE)))
+                continue;
+            const int64_t pts = pesPacket->getPts();
+            if (!firstPts.count(pid))
+                firstPts[pid] = pts;
+            if (keyFrames && pid == refPid)
+                keyFrames->emplace_back(pts, chunkPos + pos);
+        }
+        if (len < chunkSize)
+            break;
+        chunkPos += chunkSize;
+    }
+    delete[] buffer;
+}
+
+bool TSDemuxer::seekToTime(const int64_t time, const PIDSet& pids, std::map<int32_t, int64_t>& timeOffsets)
+{
+    if (!m_firstDemuxCall || strEndWith(m_streamNameLow, "ssif") ||
+        !dynamic_cast<BufferedFileReader*>(m_bufferedReader))
+        return false;
 
-        // if (acceptedPIDs.find(pid) == acceptedPIDs.end())
-        if (!m_acceptedPidCache[pid])
+    loadPmt(nullptr);
+    if (!m_entryPoints.empty() && !m_m2tsMode)
+        return false;
+    // PGS tracks keep the PES timestamps
+    PIDSet countedPids;
+    int refPid = -1;
+    for (const int pid : pids)
+    {
+        const auto itr = m_pmt.pidList.find(pid);
+        if (itr == m_pmt.pidList.end())
+            return false;
+        if (itr->second.m_streamType == StreamType::SUB_PGS)
             continue;
+        countedPids.insert(pid);
+        if (refPid == -1 || (isVideoPID(itr->second.m_streamType) && !isVideoPID(m_pmt.pidList[refPid].m_streamType)))
+            refPid = pid;
+    }
+    // the EP map gives the random access points of a Blu-ray clip, a bisection on refPid finds them otherwise
+    if (!m_entryPoints.empty())
+        refPid = m_entryPointPID;
+    if (refPid == -1)
+        return false;
+    PIDSet scannedPids = countedPids;
+    scannedPids.insert(refPid);
 
-        const int64_t payloadLen = TS_FRAME_SIZE - (frameData - m_curPos);
-        if (payloadLen > 0)
+    File file;
+    int64_t fileSize = 0;
+    if (!file.open(m_streamName.c_str(), File::ofRead) || !file.size(&fileSize))
+        return false;
+    std::map<int, int64_t> firstPts;
+    scanPesHeaders(file, 0, scannedPids, firstPts);
+    if (firstPts.size() < scannedPids.size())
+        return false;
+    const int64_t cutPts = internalClockToPts(time);
+
+    // a position is checked with the first PES of every counted pid after it
+    std::map<int, int64_t> seekPts;
+    int attempts = 0;
+    auto tryPosition = [&](const int64_t pos) {
+        attempts++;
+        scanPesHeaders(file, pos, countedPids, seekPts);
+        return seekPts.size() == countedPids.size() &&
+               std::all_of(countedPids.begin(), countedPids.end(), [&](const int pid) {
+                   return seekPts[pid] >= firstPts[pid] && seekPts[pid] - firstPts[pid] <= cutPts;
+               });
+    };
+
+    int64_t seekPos = -1;
+    if (!m_entryPoints.empty())
+    {
+        for (auto itr = m_entryPoints.rbegin(); itr != m_entryPoints.rend() && attempts < MAX_SEEK_ATTEMPTS; ++itr)
         {
-            if (pid != lastPid)
+            if (itr->m_pts - firstPts[refPid] <= cutPts && itr->m_spn > 0 &&
+                tryPosition(static_cast<int64_t>(itr->m_spn) * M2TS_FRAME_SIZE))
             {
-                vect = &demuxedData[pid];
-                lastPid = pid;
+                seekPos = static_cast<int64_t>(itr->m_spn) * M2TS_FRAME_SIZE;
+                break;
             }
-            if (vect != nullptr)
+        }
+    }
+    else
+    {
+        // the last window of the file whose first PES of refPid is before the cut. Any PES is used, as a window
+        // may hold no random access picture at high bitrates
+        std::map<int, int64_t> pts;
+        int64_t lo = 0;
+        int64_t hi = fileSize;
+        while (hi - lo > SEEK_SCAN_SIZE)
+        {
+            const int64_t mid = (lo + hi) / 2;
+            scanPesHeaders(file, mid, {refPid}, pts, false);
+            if (pts.count(refPid) && pts[refPid] >= firstPts[refPid] && pts[refPid] - firstPts[refPid] <= cutPts)
+                lo = mid;
+            else
+                hi = mid;
+        }
+        // the random access pictures of refPid are the candidates, going back a window at a time
+        std::vector<std::pair<int64_t, int64_t>> keyFrames;
+        int windows = 0;
+        for (bool lastWindow = false;
+             !lastWindow && seekPos == -1 && attempts < MAX_SEEK_ATTEMPTS && windows < MAX_SEEK_WINDOWS;
+             lo = FFMAX(lo - SEEK_SCAN_SIZE, 0))
+        {
+            lastWindow = lo == 0;
+            windows++;
+            scanPesHeaders(file, lo, {refPid}, pts, true, refPid, &keyFrames);
+            for (auto itr = keyFrames.rbegin(); itr != keyFrames.rend() && attempts < MAX_SEEK_ATTEMPTS; ++itr)
             {
-                vect->grow(payloadLen);
-                uint8_t* dst = vect->data() + vect->size() - payloadLen;
-                memcpy(dst, frameData, payloadLen);
+                if (itr->first >= firstPts[refPid] && itr->first - firstPts[refPid] <= cutPts && itr->second > 0 &&
+                    tryPosition(itr->second))
+                {
+                    seekPos = itr->second;
+                    break;
+                }
             }
         }
-        discardSize -= payloadLen;
     }
-    if (m_curPos < data + readedBytes)
+    if (seekPos == -1 || !m_bufferedReader->gotoByte(m_readerID, seekPos))
+        return false;
+
+    for (const int pid : pids) timeOffsets[pid] = 0;
+    for (const int pid : countedPids) timeOffsets[pid] = ptsToInternalClock(seekPts[pid] - firstPts[pid]);
+    // PGS timestamps are rebased on the first timestamps of the file
+    for (const auto& [pid, pts] : firstPts)
     {
-        m_tmpBufferLen = data + readedBytes - m_curPos;
-        memmove(m_tmpBuffer, m_curPos, m_tmpBufferLen);
+        if (m_firstPTS == -1 || pts < m_firstPTS)
+            m_firstPTS = pts;
+        if (isVideoPID(m_pmt.pidList[pid].m_streamType) && (m_firstVideoPTS == -1 || pts < m_firstVideoPTS))
+            m_firstVideoPTS = pts;
     }
-
-    return 0;
+    m_skippedSize = seekPos;
+    m_waitPesStart = true;
+    return true;
 }
 
 void TSDemuxer::openFile(const std::string& streamName)
@@ -36,7 +36,13 @@ class TSDemuxer final : public AbstractDemuxer
         return 0;
     }
     void setMPLSInfo(const std::vector<MPLSPlayItem>& mplsInfo) { m_mplsInfo = mplsInfo; }
+    void setEntryPoints(const CLPIParser& clpi)
+    {
+        m_entryPointPID = clpi.m_entryPointPID;
+        m_entryPoints = clpi.m_entryPoints;
+    }
     [[nodiscard]] int64_t getFileDurationNano() const override;
+    bool seekToTime(int64_t time, const PIDSet& pids, std::map<int32_t, int64_t>& timeOffsets) override;
 
    private:
     [[nodiscard]] bool mvcContinueExpected() const;
@@ -66,8 +72,7 @@ class TSDemuxer final : public AbstractDemuxer
     int64_t m_dataProcessed;
     bool m_notificated;
     TS_program_map_section m_pmt;
-    uint8_t m_tmpBuffer[TS_FRAME_SIZE + 4];
-    int64_t m_tmpBufferLen;
+    BlockCarry m_carry;  // partial TS packet at the end of the previous block
     // int64_t m_firstDTS;
     int64_t m_firstPTS;
     int64_t m_lastPTS;
@@ -81,12 +86,28 @@ class TSDemuxer final : public AbstractDemuxer
     int64_t m_lastPCRVal;
     bool m_nonMVCVideoFound;
 
-    // cache to improve speed
+    // EP map of the clip, from its CLPI file
+    int m_entryPointPID;
+    std::vector<CLPIEntryPoint> m_entryPoints;
+    int64_t m_skippedSize;  // bytes before the seek point
+    bool m_waitPesStart;    // after a seek, the accepted pids start at their next PES packet
+
+    // cache to improve speed. 1 - accepted pid, 2 - accepted after the next PES start
     uint8_t m_acceptedPidCache[8192];
+    // packets of the current block after the sync pre-pass
+    std::vector<uint32_t> m_packetOffsets;
+    std::vector<uint16_t> m_packetPids;
+    std::vector<std::pair<const uint8_t*, int>> m_runPayload;
     bool m_firstDemuxCall;
 
     static bool isVideoPID(StreamType streamType);
+    void scanPesHeaders(File& file, int64_t offset, const PIDSet& pids, std::map<int, int64_t>& firstPts,
+                        bool randomAccessOnly = true, int refPid = -1,
+                        std::vector<std::pair<int64_t, int64_t>>* keyFrames = nullptr);
     bool checkForRealM2ts(const uint8_t* buffer, const uint8_t* end) const;
+    // reads the PMT at the file start into m_pmt, detects m_m2tsMode and restores the read position. trackList, if
+    // set, receives the pids of the PMT
+    void loadPmt(std::map<int32_t, TrackInfo>* trackList);
 };
 
 #endif
@@ -11,6 +11,7 @@
 #include "mpegAudioStreamReader.h"
 #include "mpegStreamReader.h"
 #include "muxerManager.h"
+#include "outputSink.h"
 #include "pesPacket.h"
 #include "tsPacket.h"
 #include "vodCoreException.h"
@@ -22,8 +23,8 @@
 
 using namespace std;
 
-int V3_flags = 0;
-unsigned HDR10_metadata[6] = {0, 0, 0, 0, 0, 0};
+thread_local int V3_flags = 0;
+thread_local unsigned HDR10_metadata[6] = {0, 0, 0, 0, 0, 0};
 bool isV3() { return V3_flags & HDMV_V3; }
 bool is4K() { return V3_flags & FOUR_K; }
 
@@ -32,6 +33,7 @@ static constexpr int64_t SIT_INTERVAL = 76900;
 static constexpr int64_t M_CBR_PCR_DELTA = 7000;
 
 static constexpr int64_t DEFAULT_VBV_BUFFER_LEN = 500;  // default 500 ms vbv buffer
+static constexpr int PES_HEADER_BUFFER_SIZE = 2048;    // PES header + data inserted by writeAdditionData
 
 static constexpr int PAT_PID = 0;
 static constexpr int SIT_PID = 0x1f;
@@ -104,6 +106,11 @@ TSMuxer::TSMuxer(MuxerManager* owner) : AbstractMuxer(owner)
     m_lastGopNullCnt = 0;
     m_outBufLen = 0;
     m_pesData.reserve(1024 * 128);
+    m_pesRefDataSize = 0;
+    m_pesRefReader = nullptr;
+    m_pesReadPos = 0;
+    m_pesReadRefIdx = 0;
+    m_pesReadRefPos = 0;
     m_mainStreamIndex = -1;
     m_muxFile = nullptr;
     m_isExternalFile = false;
@@ -118,6 +125,8 @@ TSMuxer::TSMuxer(MuxerManager* owner) : AbstractMuxer(owner)
     setPtsOffset(0);
     m_canSwithBlock = true;
     m_additionCLPISize = 0;
+    m_tstd = nullptr;
+    m_dryRun = false;
 #ifdef _DEBUG
     m_lastProcessedDts = -1000000000;
     m_lastStreamIndex = -1;
@@ -135,9 +144,12 @@ void TSMuxer::internalReset() { m_outBufLen = 0; }
 
 TSMuxer::~TSMuxer()
 {
+    if (m_pesRefReader)
+        m_pesRefReader->setPacketDataListener(nullptr);
     delete[] m_outBuf;
     if (!m_isExternalFile)
         delete m_muxFile;
+    delete m_tstd;
 }
 
 void TSMuxer::setVBVBufferLen(const int value)
@@ -212,6 +224,8 @@ void TSMuxer::intAddStream(const std::string& streamName, const std::string& cod
         m_pgsTrackCnt++;
     }
     m_extIndexToTSIndex[streamIndex] = tsStreamIndex;
+    if (m_tstd)
+        m_tstd->addStream(tsStreamIndex, codecName);
 
     m_pmt.program_number = 1;
     if (m_pcrOnVideo)
@@ -463,6 +477,9 @@ int TSMuxer::writeOutFile(const uint8_t* buffer, const int len) const
 
 bool TSMuxer::close()
 {
+    if (m_tstd)
+        writeTSTDReport();
+
     if (m_isExternalFile)
         return true;
 
@@ -488,6 +505,23 @@ bool TSMuxer::close()
     return bRes;
 }
 
+void TSMuxer::writeTSTDReport() const
+{
+    m_tstd->finish();
+    const std::string report = m_tstd->getReport();
+    if (m_tstdReportName.empty())
+    {
+        LTRACE(LT_INFO, 2, report);
+        return;
+    }
+    const std::string fileName = m_subMode ? m_tstdReportName + ".sub" : m_tstdReportName;
+    TextFile file(fileName.c_str(), File::ofWrite);
+    if (!file.isOpen())
+        THROW(ERR_FILE_COMMON, "Can't create T-STD report file " << fileName)
+    file.write(report.c_str(), static_cast<uint32_t>(report.size()));
+    file.close();
+}
+
 int TSMuxer::calcM2tsFrameCnt() const
 {
     int32_t byteCnt = 0;
@@ -595,59 +629,97 @@ void TSMuxer::writeEmptyPacketWithPCR(const int64_t pcrVal)
     m_processedBlockSize += TS_FRAME_SIZE;
     m_pcrBits += TS_FRAME_SIZE * 8;
     m_muxedPacketCnt[m_muxedPacketCnt.size() - 1]++;
+    if (m_tstd)
+    {
+        m_tstd->addPacket(m_pmt.pcr_pid, 0);
+        m_tstd->onPCR(pcrVal);
+    }
     if (m_m2tsMode)
         processM2TSPCR(pcrVal, 0);
     writeOutBuffer();
 }
 
-void TSMuxer::buildPesHeader(const uint8_t pesStreamID, AVPacket& avPacket, int pid)
+void TSMuxer::buildPesHeader(const uint8_t pesStreamID, AVPacket& avPacket, const int pid)
 {
     const int64_t curDts = internalClockToPts(avPacket.dts) + m_timeOffset;
     const int64_t curPts = internalClockToPts(avPacket.pts) + m_timeOffset;
-    uint8_t tmpBuffer[2048]{0};
-    const auto pesPacket = reinterpret_cast<PESPacket*>(tmpBuffer);
-    if (curDts != curPts)
-        pesPacket->serialize(curPts, curDts, pesStreamID);
-    else
-        pesPacket->serialize(curPts, pesStreamID);
+    const bool withDts = curDts != curPts;
+    const auto ast = dynamic_cast<AbstractStreamReader*>(avPacket.codec);
+    const int extensionKey = ast ? ast->getPESExtensionKey(avPacket) : 0;
+
+    StreamInfo& streamInfo = m_streamInfo[pid];
+    if (streamInfo.m_pesHeaderLen == 0 || streamInfo.m_pesStreamID != pesStreamID ||
+        streamInfo.m_pesWithDts != withDts || streamInfo.m_pesExtensionKey != extensionKey)
+    {
+        // stream parameters are changed. Rebuild the header template
+        uint8_t tmpBuffer[StreamInfo::PES_HEADER_TEMPLATE_SIZE]{0};
+        const auto pesPacket = reinterpret_cast<PESPacket*>(tmpBuffer);
+        if (withDts)
+            pesPacket->serialize(curPts, curDts, pesStreamID);
+        else
+            pesPacket->serialize(curPts, pesStreamID);
+        pesPacket->flagsHi |= PES_DATA_ALIGNMENT;
+        if (ast)
+            ast->writePESExtension(pesPacket, avPacket);
+        assert(pesPacket->getHeaderLength() <= StreamInfo::PES_HEADER_TEMPLATE_SIZE);
+        memcpy(streamInfo.m_pesHeader, tmpBuffer, pesPacket->getHeaderLength());
+        streamInfo.m_pesHeaderLen = pesPacket->getHeaderLength();
+        streamInfo.m_pesStreamID = pesStreamID;
+        streamInfo.m_pesWithDts = withDts;
+        streamInfo.m_pesExtensionKey = extensionKey;
+    }
     m_lastPESDTS = curDts;
     m_fullPesDTS = avPacket.dts;
     m_fullPesPTS = avPacket.pts;
-    pesPacket->flagsHi |= PES_DATA_ALIGNMENT;
-    // int additionDataSize = avPacket.codec->writePESExtension(pesPacket);
-    const auto ast = dynamic_cast<AbstractStreamReader*>(avPacket.codec);
-    if (ast)
-        ast->writePESExtension(pesPacket, avPacket);
+
+    // header and additional codec data are written directly to the PES buffer
+    const int headerLen = streamInfo.m_pesHeaderLen;
+    m_pesData.resize(PES_HEADER_BUFFER_SIZE);
+    uint8_t* dst = m_pesData.data();
+    memcpy(dst, streamInfo.m_pesHeader, headerLen);
+    const auto pesPacket = reinterpret_cast<PESPacket*>(dst);
+    if (withDts)
+        pesPacket->setPtsAndDts(curPts, curDts);
+    else
+        pesPacket->setPts(curPts);
     if (avPacket.flags & AVPacket::IS_COMPLETE_FRAME)
-        pesPacket->setPacketLength(avPacket.size + pesPacket->getHeaderLength());
+        pesPacket->setPacketLength(avPacket.size + headerLen);
 
     PriorityDataInfo tmpPriorityData;
-    const int additionDataSize = avPacket.codec->writeAdditionData(
-        tmpBuffer + pesPacket->getHeaderLength(), tmpBuffer + sizeof(tmpBuffer), avPacket, &tmpPriorityData);
-    const int bufLen = pesPacket->getHeaderLength() + additionDataSize;
-    m_pesData.resize(bufLen);
-    memcpy(m_pesData.data(), tmpBuffer, bufLen);
-    for (auto& i : tmpPriorityData) m_priorityData.emplace_back(i.first + pesPacket->getHeaderLength(), i.second);
+    const int additionDataSize =
+        avPacket.codec->writeAdditionData(dst + headerLen, dst + PES_HEADER_BUFFER_SIZE, avPacket, &tmpPriorityData);
+    m_pesData.resize(headerLen + additionDataSize);
+    for (auto& i : tmpPriorityData) m_priorityData.emplace_back(i.first + headerLen, i.second);
 }
 
 void TSMuxer::addData(const uint8_t pesStreamID, const int pid, AVPacket& avPacket)
 {
-    int beforePesLen = static_cast<int>(m_pesData.size());
-    if (m_pesData.size() == 0)
+    int beforePesLen = static_cast<int>(pesDataSize());
+    if (beforePesLen == 0)
     {
         buildPesHeader(pesStreamID, avPacket, pid);
         m_pesPID = pid;
         m_pesIFrame = avPacket.flags & AVPacket::IS_IFRAME;
         m_pesSpsPps = avPacket.flags & AVPacket::IS_SPS_PPS_IN_GOP;
     }
-    const int oldLen = static_cast<int>(m_pesData.size());
+    const int oldLen = static_cast<int>(pesDataSize());
     const int pesHeaderLen = oldLen - beforePesLen;
     if (oldLen > 100000000)
         THROW(ERR_COMMON, "Pes packet len too large ( >100Mb). Bad stream or invalid codec speciffed.")
-    m_pesData.grow(avPacket.size /*+ additionDataSize*/);
-    uint8_t* dst = m_pesData.data() + oldLen;
-    // memcpy(dst, tmpBuffer, additionDataSize);
-    memcpy(dst /*+ additionDataSize*/, avPacket.data, avPacket.size);
+    const auto reader = dynamic_cast<AbstractStreamReader*>(avPacket.codec);
+    if (avPacket.size > 0 && reader && reader->isPacketDataStable())
+    {
+        // keep payload in the reader buffer until the PES packet is written or the reader releases it
+        m_pesRefData.emplace_back(avPacket.data, avPacket.size);
+        m_pesRefDataSize += avPacket.size;
+        m_pesRefReader = reader;
+        reader->setPacketDataListener(this);
+    }
+    else
+    {
+        storePesRefData();
+        m_pesData.append(avPacket.data, avPacket.size);
+    }
     if (avPacket.flags & AVPacket::PRIORITY_DATA)
     {
         if (!m_priorityData.empty() && m_priorityData.rbegin()->first + m_priorityData.rbegin()->second == beforePesLen)
@@ -657,6 +729,56 @@ void TSMuxer::addData(const uint8_t pesStreamID, const int pid, AVPacket& avPack
     }
 }
 
+void TSMuxer::storePesRefData()
+{
+    for (const auto& [data, size] : m_pesRefData) m_pesData.append(data, size);
+    clearPesRefData();
+}
+
+void TSMuxer::clearPesRefData()
+{
+    m_pesRefData.clear();
+    m_pesRefDataSize = 0;
+    if (m_pesRefReader)
+    {
+        m_pesRefReader->setPacketDataListener(nullptr);
+        m_pesRefReader = nullptr;
+    }
+}
+
+void TSMuxer::onPacketDataRelease(AbstractStreamReader* reader)
+{
+    m_pesRefReader = nullptr;  // listener is already detached by the reader
+    storePesRefData();
+}
+
+void TSMuxer::copyPesData(uint8_t* dst, int64_t len)
+{
+    const auto pesDataLen = static_cast<int64_t>(m_pesData.size());
+    if (m_pesReadPos < pesDataLen)
+    {
+        const int64_t chunk = FFMIN(len, pesDataLen - m_pesReadPos);
+        memcpy(dst, m_pesData.data() + m_pesReadPos, chunk);
+        dst += chunk;
+        len -= chunk;
+        m_pesReadPos += chunk;
+    }
+    while (len > 0)
+    {
+        const auto& [data, size] = m_pesRefData[m_pesReadRefIdx];
+        const int64_t chunk = FFMIN(len, size - m_pesReadRefPos);
+        memcpy(dst, data + m_pesReadRefPos, chunk);
+        dst += chunk;
+        len -= chunk;
+        m_pesReadRefPos += static_cast<int>(chunk);
+        if (m_pesReadRefPos == size)
+        {
+            m_pesReadRefIdx++;
+            m_pesReadRefPos = 0;
+        }
+    }
+}
+
 void TSMuxer::flushTSFrame() { writePESPacket(); }
 
 void TSMuxer::writePATPMT(const int64_t pcr, const bool force)
@@ -757,11 +879,11 @@ void TSMuxer::gotoNextFile(const int64_t newPts)
 
 void TSMuxer::writePESPacket()
 {
-    if (m_pesData.size() > 0)
+    if (pesDataSize() > 0)
     {
         uint32_t tsPackets = 0;
 
-        const size_t size = m_pesData.size() - 6;
+        const size_t size = pesDataSize() - 6;
         if (size <= 0xffff)
         {
             m_pesData.data()[4] = static_cast<uint8_t>(size / 256);
@@ -815,23 +937,28 @@ void TSMuxer::writePESPacket()
             }
         }
 
-        const uint8_t* curPtr = m_pesData.data();
-        const uint8_t* dataEnd = curPtr + m_pesData.size();
+        int64_t curPos = 0;
+        const auto dataEnd = static_cast<int64_t>(pesDataSize());
+        if (m_tstd)
+            m_tstd->startPES(m_pesPID, m_lastPESDTS, dataEnd - pesPacket->getHeaderLength());
         bool payloadStart = true;
-        for (const auto& i : m_priorityData)
+        m_pesReadPos = 0;
+        m_pesReadRefIdx = 0;
+        m_pesReadRefPos = 0;
+        for (const auto& [blockPos, blockLen] : m_priorityData)
         {
-            const uint8_t* blockPtr = m_pesData.data() + i.first;
-            if (blockPtr > curPtr)
+            if (blockPos > curPos)
             {
-                tsPackets += writeTSFrames(m_pesPID, curPtr, blockPtr - curPtr, false, payloadStart);
+                tsPackets += writeTSFrames(m_pesPID, blockPos - curPos, false, payloadStart);
                 payloadStart = false;
             }
-            tsPackets += writeTSFrames(m_pesPID, blockPtr, i.second, true, payloadStart);
-            curPtr = blockPtr + i.second;
+            tsPackets += writeTSFrames(m_pesPID, blockLen, true, payloadStart);
+            curPos = blockPos + blockLen;
         }
-        tsPackets += writeTSFrames(m_pesPID, curPtr, dataEnd - curPtr, false, payloadStart);
+        tsPackets += writeTSFrames(m_pesPID, dataEnd - curPos, false, payloadStart);
 
         m_pesData.resize(0);
+        clearPesRefData();
         m_priorityData.clear();
         if (updateIdx)
         {
@@ -1034,13 +1161,12 @@ bool TSMuxer::muxPacket(AVPacket& avPacket)
     return true;
 }
 
-int TSMuxer::writeTSFrames(const int pid, const uint8_t* buffer, const int64_t len, const bool priorityData,
-                           bool payloadStart)
+int TSMuxer::writeTSFrames(const int pid, const int64_t len, const bool priorityData, bool payloadStart)
 {
     int result = 0;
 
-    const uint8_t* curPos = buffer;
-    const uint8_t* end = buffer + len;
+    int64_t curPos = 0;
+    const int64_t end = len;
 
     const bool tsPriority = priorityData;
     StreamInfo& streamInfo = m_streamInfo[pid];
@@ -1102,7 +1228,10 @@ int TSMuxer::writeTSFrames(const int pid, const uint8_t* buffer, const int64_t l
             payloadLen = tmpBufferLen;
         }
         const int tsHeaderSize = tsPacket->getHeaderSize();
-        memcpy(m_outBuf + m_outBufLen + tsHeaderSize, curPos, payloadLen);
+        if (!m_dryRun)
+            copyPesData(m_outBuf + m_outBufLen + tsHeaderSize, payloadLen);
+        if (m_tstd)
+            m_tstd->addPacket(pid, static_cast<int>(payloadLen));
 
         curPos += payloadLen;
         m_outBufLen += TS_FRAME_SIZE;
@@ -1183,6 +1312,8 @@ void TSMuxer::writeNullPackets(const int cnt)
         memcpy(m_outBuf + m_outBufLen, m_nullBuffer, TS_FRAME_SIZE);
         const auto tsPacket = reinterpret_cast<TSPacket*>(m_outBuf + m_outBufLen);
         tsPacket->counter = m_nullCnt++;
+        if (m_tstd)
+            m_tstd->addPacket(NULL_PID, 0);
         m_outBufLen += TS_FRAME_SIZE;
         m_processedBlockSize += TS_FRAME_SIZE;
         m_pcrBits += TS_FRAME_SIZE * 8;
@@ -1227,6 +1358,8 @@ void TSMuxer::writePAT()
     memcpy(m_outBuf + m_outBufLen, m_patBuffer, TS_FRAME_SIZE);
     const auto tsPacket = reinterpret_cast<TSPacket*>(m_outBuf + m_outBufLen);
     tsPacket->counter = m_patCnt++;
+    if (m_tstd)
+        m_tstd->addPacket(PAT_PID, 0);
     m_outBufLen += TS_FRAME_SIZE;
     m_processedBlockSize += TS_FRAME_SIZE;
     m_pcrBits += TS_FRAME_SIZE * 8;
@@ -1248,6 +1381,8 @@ void TSMuxer::writePMT()
         memcpy(m_outBuf + m_outBufLen, curPos, TS_FRAME_SIZE);
         const auto tsPacket = reinterpret_cast<TSPacket*>(m_outBuf + m_outBufLen);
         tsPacket->counter = m_pmtCnt++;
+        if (m_tstd)
+            m_tstd->addPacket(DEFAULT_PMT_PID, 0);
         m_outBufLen += TS_FRAME_SIZE;
         m_processedBlockSize += TS_FRAME_SIZE;
         m_pcrBits += TS_FRAME_SIZE * 8;
@@ -1268,6 +1403,8 @@ void TSMuxer::writeSIT()
     memcpy(m_outBuf + m_outBufLen, DefaultSitTableOne, TS_FRAME_SIZE);
     const auto tsPacket = reinterpret_cast<TSPacket*>(m_outBuf + m_outBufLen);
     tsPacket->counter = m_sitCnt++;
+    if (m_tstd)
+        m_tstd->addPacket(SIT_PID, 0);
     m_outBufLen += TS_FRAME_SIZE;
     m_processedBlockSize += TS_FRAME_SIZE;
     m_pcrBits += TS_FRAME_SIZE * 8;
@@ -1325,6 +1462,8 @@ void TSMuxer::writeOutBuffer()
 void TSMuxer::parseMuxOpt(const std::string& opts)
 {
     const vector<string> params = splitStr(opts.c_str(), ' ');
+    bool dryRun = false;
+    OutputSinkType sinkType = OutputSinkType::None;
     for (auto& i : params)
     {
         vector<string> paramPair = splitStr(trimStr(i).c_str(), '=');
@@ -1385,7 +1524,23 @@ void TSMuxer::parseMuxOpt(const std::string& opts)
         {
             m_computeMuxStats = true;
         }
+        else if (paramPair[0] == "--tstd-report")
+        {
+            if (!m_tstd)
+                m_tstd = new TSTDSimulator();
+            if (paramPair.size() > 1)
+                m_tstdReportName = paramPair[1];
+        }
+        else if (paramPair[0] == "--dry-run")
+            dryRun = true;
+        else if (paramPair[0] == "--output-sink" && paramPair.size() > 1)
+            sinkType = outputSinkTypeFromString(paramPair[1]);
     }
+    // --output-sink overrides --dry-run regardless of the argument order (same rule as MuxerManager)
+    if (sinkType != OutputSinkType::None)
+        m_dryRun = sinkType == OutputSinkType::Discard;
+    else if (dryRun)
+        m_dryRun = true;
 }
 
 void TSMuxer::setSubMode(AbstractMuxer* mainMuxer, const bool flushInterleavedBlock)
@@ -10,6 +10,7 @@
 #include "avPacket.h"
 #include "hevc.h"
 #include "limits.h"
+#include "tstdSimulator.h"
 
 enum V3Flags
 {
@@ -23,14 +24,15 @@ enum V3Flags
     BL_NOTCOMPAT = 128
 };
 
-extern int V3_flags;
-extern unsigned HDR10_metadata[6];
+// per thread, files probed in parallel must not see each other's flags
+extern thread_local int V3_flags;
+extern thread_local unsigned HDR10_metadata[6];
 extern bool isV3();
 extern bool is4K();
 
 static constexpr int MAX_PES_HEADER_LEN = 512;
 
-class TSMuxer final : public AbstractMuxer
+class TSMuxer final : public AbstractMuxer, public PacketDataListener
 {
     typedef AbstractMuxer base_class;
 
@@ -69,6 +71,8 @@ class TSMuxer final : public AbstractMuxer
 
     void setPtsOffset(int64_t value);
 
+    void onPacketDataRelease(AbstractStreamReader* reader) override;
+
    protected:
     bool muxPacket(AVPacket& avPacket) override;
     void internalReset();
@@ -79,13 +83,14 @@ class TSMuxer final : public AbstractMuxer
    private:
     bool doFlush(int64_t newPCR, int64_t pcrGAP);
     void flushTSFrame();
-    int writeTSFrames(int pid, const uint8_t* buffer, int64_t len, bool priorityData, bool payloadStart);
+    int writeTSFrames(int pid, int64_t len, bool priorityData, bool payloadStart);
     void writeSIT();
     void writePMT();
     void writePAT();
     void writeNullPackets(int cnt);
     void writeOutBuffer();
     void writeEmptyPacketWithPCR(int64_t pcrVal);
+    void writeTSTDReport() const;
     void buildNULL();
     void buildPAT();
     void buildPMT();
@@ -93,6 +98,10 @@ class TSMuxer final : public AbstractMuxer
     void addData(uint8_t pesStreamID, int pid, AVPacket& avPacket);
     void buildPesHeader(uint8_t pesStreamID, AVPacket& avPacket, int pid);
     void writePESPacket();
+    [[nodiscard]] size_t pesDataSize() const { return m_pesData.size() + m_pesRefDataSize; }
+    void copyPesData(uint8_t* dst, int64_t len);
+    void storePesRefData();
+    void clearPesRefData();
     void processM2TSPCR(int64_t pcrVal, int64_t pcrGAP);
     [[nodiscard]] inline int calcM2tsFrameCnt() const;
     static void writeM2TSHeader(uint8_t* buffer, const int64_t m2tsPCR)
@@ -154,10 +163,22 @@ class TSMuxer final : public AbstractMuxer
         {
             m_pts = m_dts = ULLONG_MAX;
             m_tsCnt = 0;
+            m_pesHeaderLen = 0;
+            m_pesStreamID = 0;
+            m_pesWithDts = false;
+            m_pesExtensionKey = 0;
         }
         int64_t m_pts;
         int64_t m_dts;
         int m_tsCnt;
+
+        // cached PES header. Only PTS/DTS and the packet length are patched for each access unit
+        static constexpr int PES_HEADER_TEMPLATE_SIZE = 32;
+        uint8_t m_pesHeader[PES_HEADER_TEMPLATE_SIZE];
+        int m_pesHeaderLen;  // 0 - template is not built yet
+        uint8_t m_pesStreamID;
+        bool m_pesWithDts;
+        int m_pesExtensionKey;
     };
 
     int64_t m_minDts;
@@ -189,6 +210,13 @@ class TSMuxer final : public AbstractMuxer
     bool m_needTruncate;
     int64_t m_lastMuxedDts;
     MemoryBlock m_pesData;
+    // PES payload referenced in place in the stream reader buffer. It follows m_pesData
+    std::vector<std::pair<const uint8_t*, int>> m_pesRefData;
+    size_t m_pesRefDataSize;
+    AbstractStreamReader* m_pesRefReader;
+    int64_t m_pesReadPos;  // copyPesData read position in m_pesData
+    size_t m_pesReadRefIdx;
+    int m_pesReadRefPos;
     int m_pesPID;
     std::vector<uint32_t> m_muxedPacketCnt;
     bool m_pesIFrame;
@@ -213,6 +241,9 @@ class TSMuxer final : public AbstractMuxer
     bool m_canSwithBlock;
     int64_t m_additionCLPISize;
     std::vector<std::string> m_fileNames;
+    TSTDSimulator* m_tstd;  // not null if --tstd-report is specified
+    std::string m_tstdReportName;
+    bool m_dryRun;  // output is discarded. TS packet payload is not copied
 #ifdef _DEBUG
     int64_t m_lastProcessedDts;
     int m_lastStreamIndex;
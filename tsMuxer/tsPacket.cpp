@@ -777,11 +777,65 @@ void CLPIParser::parseCPI(uint8_t* buffer, const uint8_t* end)
 {
     BitStreamReader reader{};
     reader.setBuffer(buffer, end);
-    if (reader.getBits(32) != 0)  // length
-        reader.skipBits(16);      // reserved_for_word_align, CPI_type (1 is typical value)
+    if (reader.getBits(32) == 0)  // length
+        return;
+    reader.skipBits(12);         // reserved_for_word_align
+    if (reader.getBits(4) != 1)  // CPI_type
+        return;
+    try
+    {
+        EP_map(buffer + 6, end);
+    }
+    catch (BitStreamException&)
+    {
+        m_entryPoints.clear();  // the clip is read from the start
+    }
 }
 
-void CLPIParser::EP_map(BitStreamReader& reader) {}
+void CLPIParser::EP_map(uint8_t* buffer, const uint8_t* end)
+{
+    BitStreamReader reader{};
+    reader.setBuffer(buffer, end);
+    reader.skipBits(8);          // reserved_for_word_align
+    if (reader.getBits(8) == 0)  // number_of_stream_PID_entries
+        return;
+    // the first stream is the video one when the clip has video
+    m_entryPointPID = reader.getBits<int>(16);  // stream_PID[0]
+    reader.skipBits(14);                        // reserved_for_word_align, EP_stream_type
+    const unsigned coarseCnt = reader.getBits(16);
+    const unsigned fineCnt = reader.getBits(18);
+    const uint32_t mapStart = reader.getBits(32);  // EP_map_for_one_stream_PID_start_address[0]
+    if (buffer + mapStart >= end)
+        return;
+
+    reader.setBuffer(buffer + mapStart, end);
+    const uint32_t fineStart = reader.getBits(32);  // EP_fine_table_start_address
+    std::vector<BluRayCoarseInfo> coarseInfo;
+    for (unsigned i = 0; i < coarseCnt; ++i)
+    {
+        const uint32_t fineRefID = reader.getBits(18);
+        const uint32_t coarsePts = reader.getBits(14);
+        coarseInfo.emplace_back(coarsePts, fineRefID, reader.getBits(32));
+    }
+    if (coarseInfo.empty() || buffer + mapStart + fineStart >= end)
+        return;
+
+    reader.setBuffer(buffer + mapStart + fineStart, end);
+    m_entryPoints.clear();
+    m_entryPoints.reserve(fineCnt);
+    size_t coarseIdx = 0;
+    for (uint32_t i = 0; i < fineCnt; ++i)
+    {
+        reader.skipBits(4);  // is_angle_change_point, I_end_position_offset
+        const uint32_t finePts = reader.getBits(11);
+        const uint32_t fineSpn = reader.getBits(17);
+        while (coarseIdx + 1 < coarseInfo.size() && coarseInfo[coarseIdx + 1].m_fineRefID <= i) coarseIdx++;
+        // the coarse and fine parts overlap at PTS bit 19
+        const BluRayCoarseInfo& coarse = coarseInfo[coarseIdx];
+        const int64_t pts = (static_cast<int64_t>(coarse.m_coarsePts & ~1) << 19) + (finePts << 9);
+        m_entryPoints.emplace_back(pts, (coarse.m_pktCnt & 0xfffe0000) + fineSpn);
+    }
+}
 
 void CLPIParser::composeCPI(BitStreamWriter& writer, const bool isCPIExt)
 {
@@ -1020,7 +1074,7 @@ void CLPIParser::ProgramInfo_SS(uint8_t* buffer, const unsigned dataLength)
     parseProgramInfo(buffer, buffer + dataLength, m_programInfoMVC, m_streamInfoMVC);
 }
 
-void CLPIParser::CPI_SS(uint8_t* buffer, const unsigned dataLength) { parseCPI(buffer, buffer + dataLength); }
+void CLPIParser::CPI_SS(uint8_t*, unsigned) {}  // the EP map of the dependent view is not used
 
 void CLPIParser::composeExtentStartPoint(BitStreamWriter& writer) const
 {
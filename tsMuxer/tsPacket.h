@@ -216,6 +216,14 @@ struct BluRayCoarseInfo
     }
 };
 
+// EP_map entry of a clip: the source packet where a random access picture starts
+struct CLPIEntryPoint
+{
+    int64_t m_pts;   // 90 kHz
+    uint32_t m_spn;  // source packet number
+    CLPIEntryPoint(const int64_t pts, const uint32_t spn) : m_pts(pts), m_spn(spn) {}
+};
+
 struct PMTIndexData
 {
     uint32_t m_pktCnt;
@@ -425,7 +433,8 @@ class CLPIParser
           presentation_start_time(0),
           presentation_end_time(0),
           m_clpiNum(0),
-          isDependStream(false)
+          isDependStream(false),
+          m_entryPointPID(0)
     {
     }
 
@@ -453,6 +462,8 @@ class CLPIParser
     std::vector<uint32_t> SPN_extent_start;
     std::vector<int32_t> interleaveInfo;
     bool isDependStream;
+    int m_entryPointPID;                        // stream of the EP map entries, the video one if any
+    std::vector<CLPIEntryPoint> m_entryPoints;  // ordered by SPN
 
    private:
     static void HDMV_LPCM_down_mix_coefficient(uint8_t* buffer, unsigned dataLength);
@@ -463,8 +474,8 @@ class CLPIParser
     static void parseProgramInfo(uint8_t* buffer, const uint8_t* end, std::vector<CLPIProgramInfo>& programInfoMap,
                                  std::map<int, CLPIStreamInfo>& streamInfoMap);
     void parseSequenceInfo(uint8_t* buffer, const uint8_t* end);
-    static void parseCPI(uint8_t* buffer, const uint8_t* end);
-    static void EP_map(BitStreamReader& reader);
+    void parseCPI(uint8_t* buffer, const uint8_t* end);
+    void EP_map(uint8_t* buffer, const uint8_t* end);
     static void parseClipMark(uint8_t* buffer, const uint8_t* end);
     void parseClipInfo(BitStreamReader& reader);
     void parseExtensionData(uint8_t* buffer, const uint8_t* end);
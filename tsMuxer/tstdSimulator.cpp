@@ -0,0 +1,226 @@
+#include "tstdSimulator.h"
+
+#include <cmath>
+#include <iomanip>
+#include <limits>
+
+#include "tsPacket.h"
+#include "vod_common.h"
+
+static constexpr int TB_SIZE = 512;  // transport buffer size, bytes
+static constexpr int64_t PCR_TICKS_PER_SECOND = 90000;
+
+TSTDSimulator::PidState::PidState()
+    : rxRate(0),
+      ebSize(0),
+      tbFill(0.0),
+      lastTime(-1.0),
+      ebFill(0),
+      lateBytes(0),
+      ebOverflow(false),
+      secBytes(0),
+      secMaxEb(0),
+      secUnderflows(0),
+      secEbOverflows(0),
+      secTbOverflows(0),
+      peakBitrate(0),
+      peakEb(0),
+      underflows(0),
+      ebOverflows(0),
+      tbOverflows(0)
+{
+}
+
+TSTDSimulator::TSTDSimulator()
+    : m_lastPCR(-1),
+      m_lastTickPerPacket(0.0),
+      m_firstTime(-1),
+      m_curSecond(-1),
+      m_secTotalBytes(0),
+      m_peakTotalBitrate(0)
+{
+}
+
+void TSTDSimulator::addStream(const int pid, const std::string& codecName, const int64_t rxRate, const int64_t ebSize)
+{
+    PidState& state = m_pids[pid];
+    state.codecName = codecName;
+    state.rxRate = rxRate;
+    state.ebSize = ebSize;
+}
+
+void TSTDSimulator::addStream(const int pid, const std::string& codecName)
+{
+    // Rx is 1.2 * max elementary rate, EB is the decoder buffer of the highest level used on Blu-ray
+    if (codecName == "V_MPEG-2")
+        addStream(pid, codecName, 48000000, 1222656);  // MP@HL VBV
+    else if (codecName == "V_MPEGH/ISO/HEVC" || codecName == "V_MPEGI/ISO/VVC")
+        addStream(pid, codecName, 153600000, 22000000);  // level 5.1 high tier CPB
+    else if (codecName[0] == 'V')
+        addStream(pid, codecName, 48000000, 9375000);  // level 4.1 NAL CPB
+    else if (codecName == "A_MP3" || codecName == "A_AAC")
+        addStream(pid, codecName, 2000000, 3584);
+    else if (codecName[0] == 'A')
+        addStream(pid, codecName, 33177600, 65536);  // lossless audio may be carried in the same PID
+    else
+        addStream(pid, codecName, 16000000, 1048576);
+}
+
+void TSTDSimulator::startPES(const int pid, const int64_t dts, const int64_t payloadLen)
+{
+    const auto itr = m_pids.find(pid);
+    if (itr != m_pids.end())
+        itr->second.accessUnits.push_back(AccessUnit{dts, payloadLen, 0});
+}
+
+void TSTDSimulator::addPacket(const int pid, const int payloadLen)
+{
+    m_pending.push_back(PendingPacket{pid, payloadLen});
+}
+
+void TSTDSimulator::onPCR(const int64_t pcr)
+{
+    if (m_pending.empty())
+        return;
+    double ticksPerPacket = 0.0;
+    if (m_lastPCR != -1)
+        ticksPerPacket = static_cast<double>(pcr - m_lastPCR) / static_cast<double>(m_pending.size());
+    const double startTime = m_lastPCR != -1 ? static_cast<double>(m_lastPCR) : static_cast<double>(pcr);
+    for (size_t i = 0; i < m_pending.size(); ++i)
+        processPacket(m_pending[i], startTime + ticksPerPacket * static_cast<double>(i + 1));
+    m_pending.clear();
+    m_lastPCR = pcr;
+    if (ticksPerPacket > 0)
+        m_lastTickPerPacket = ticksPerPacket;
+}
+
+void TSTDSimulator::finish()
+{
+    // there is no PCR after the last packets. Keep the previous rate
+    if (!m_pending.empty() && m_lastPCR != -1)
+        onPCR(m_lastPCR + llround(m_lastTickPerPacket * static_cast<double>(m_pending.size())));
+    for (auto& [pid, state] : m_pids) removeAccessUnits(state, std::numeric_limits<double>::max());
+    flushSecond();
+}
+
+void TSTDSimulator::removeAccessUnits(PidState& state, const double time)
+{
+    while (!state.accessUnits.empty() && state.accessUnits.front().dts <= time)
+    {
+        const AccessUnit& au = state.accessUnits.front();
+        if (au.received < au.size)
+        {
+            // access unit is not completely in EB at decoding time
+            if (time != std::numeric_limits<double>::max())
+            {
+                state.secUnderflows++;
+                state.underflows++;
+            }
+            state.lateBytes += au.size - au.received;
+        }
+        state.ebFill -= au.received;
+        state.accessUnits.pop_front();
+    }
+    if (state.ebFill <= state.ebSize)
+        state.ebOverflow = false;
+}
+
+void TSTDSimulator::processPacket(const PendingPacket& packet, const double time)
+{
+    if (m_firstTime == -1)
+        m_firstTime = static_cast<int64_t>(time);
+    const int64_t second = (static_cast<int64_t>(time) - m_firstTime) / PCR_TICKS_PER_SECOND;
+    if (second != m_curSecond)
+    {
+        flushSecond();
+        m_curSecond = second;
+    }
+    m_secTotalBytes += TS_FRAME_SIZE;
+
+    const auto itr = m_pids.find(packet.pid);
+    if (itr == m_pids.end())
+        return;  // PSI, PCR and NULL packets are counted in the total bitrate only
+    PidState& state = itr->second;
+    state.secBytes += TS_FRAME_SIZE;
+
+    // transport buffer
+    if (state.lastTime >= 0)
+    {
+        const double leaked = static_cast<double>(state.rxRate) / 8.0 * (time - state.lastTime) / PCR_TICKS_PER_SECOND;
+        state.tbFill = FFMAX(0.0, state.tbFill - leaked);
+    }
+    state.lastTime = time;
+    if (state.tbFill + TS_FRAME_SIZE > TB_SIZE)
+    {
+        state.secTbOverflows++;
+        state.tbOverflows++;
+    }
+    state.tbFill = FFMIN(static_cast<double>(TB_SIZE), state.tbFill + TS_FRAME_SIZE);
+
+    // elementary buffer
+    removeAccessUnits(state, time);
+    int64_t payload = packet.payloadLen;
+    const int64_t late = FFMIN(payload, state.lateBytes);
+    state.lateBytes -= late;
+    payload -= late;
+    for (auto& au : state.accessUnits)
+    {
+        if (payload == 0)
+            break;
+        const int64_t toAU = FFMIN(payload, au.size - au.received);
+        au.received += toAU;
+        state.ebFill += toAU;
+        payload -= toAU;
+    }
+    if (state.ebFill > state.ebSize && !state.ebOverflow)
+    {
+        state.ebOverflow = true;
+        state.secEbOverflows++;
+        state.ebOverflows++;
+    }
+    state.secMaxEb = FFMAX(state.secMaxEb, state.ebFill);
+    state.peakEb = FFMAX(state.peakEb, state.ebFill);
+}
+
+void TSTDSimulator::flushSecond()
+{
+    if (m_curSecond < 0)
+        return;
+    const int64_t totalBitrate = m_secTotalBytes * 8;
+    m_peakTotalBitrate = FFMAX(m_peakTotalBitrate, totalBitrate);
+    m_report << std::setw(6) << m_curSecond << "s total " << totalBitrate / 1000 << " kbps";
+    for (auto& [pid, state] : m_pids)
+    {
+        const int64_t bitrate = state.secBytes * 8;
+        state.peakBitrate = FFMAX(state.peakBitrate, bitrate);
+        m_report << "; 0x" << std::hex << pid << std::dec << " " << bitrate / 1000 << " kbps eb "
+                 << state.secMaxEb * 100 / state.ebSize << "%";
+        if (state.secUnderflows)
+            m_report << " uf " << state.secUnderflows;
+        if (state.secEbOverflows)
+            m_report << " of " << state.secEbOverflows;
+        if (state.secTbOverflows)
+            m_report << " tb " << state.secTbOverflows;
+        state.secBytes = 0;
+        state.secMaxEb = state.ebFill;
+        state.secUnderflows = state.secEbOverflows = state.secTbOverflows = 0;
+    }
+    m_report << "\n";
+    m_secTotalBytes = 0;
+}
+
+std::string TSTDSimulator::getReport() const
+{
+    std::ostringstream rez;
+    rez << "T-STD report. uf - access unit is incomplete at its DTS, of - EB overflow, tb - TB overflow\n";
+    for (const auto& [pid, state] : m_pids)
+        rez << "PID 0x" << std::hex << pid << std::dec << " " << state.codecName << ": Rx " << state.rxRate / 1000
+            << " kbps, TB " << TB_SIZE << " bytes, EB " << state.ebSize << " bytes\n";
+    rez << m_report.str();
+    rez << "Summary: peak total " << m_peakTotalBitrate / 1000 << " kbps\n";
+    for (const auto& [pid, state] : m_pids)
+        rez << "PID 0x" << std::hex << pid << std::dec << ": peak " << state.peakBitrate / 1000 << " kbps, peak EB "
+            << state.peakEb << " bytes (" << state.peakEb * 100 / state.ebSize << "%), underflows " << state.underflows
+            << ", EB overflows " << state.ebOverflows << ", TB overflows " << state.tbOverflows << "\n";
+    return rez.str();
+}
@@ -0,0 +1,95 @@
+#ifndef TSTD_SIMULATOR_H_
+#define TSTD_SIMULATOR_H_
+
+#include <types/types.h>
+
+#include <deque>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Simplified ISO/IEC 13818-1 transport stream system target decoder (T-STD).
+// Tracks transport buffer (TB) and elementary buffer (EB) fill for every PID while the muxer emits TS packets and
+// collects per second statistics. All times are in the 90 kHz PCR clock.
+// Packet arrival times are interpolated between PCR values, the same way the M2TS arrival timestamps are computed.
+class TSTDSimulator
+{
+   public:
+    TSTDSimulator();
+
+    // rxRate: TB leak rate in bits per second. ebSize: elementary buffer size in bytes.
+    void addStream(int pid, const std::string& codecName, int64_t rxRate, int64_t ebSize);
+    void addStream(int pid, const std::string& codecName);  // use default buffer model for the codec
+
+    // register the next PES (access unit) of the pid. It is removed from EB at its DTS
+    void startPES(int pid, int64_t dts, int64_t payloadLen);
+    // TS packet is written to the output
+    void addPacket(int pid, int payloadLen);
+    // PCR packet is written to the output. Packets written since the previous PCR get their arrival times
+    void onPCR(int64_t pcr);
+    // process the packets written after the last PCR and close the statistics
+    void finish();
+
+    [[nodiscard]] std::string getReport() const;
+
+   private:
+    struct AccessUnit
+    {
+        int64_t dts;
+        int64_t size;
+        int64_t received;
+    };
+
+    struct PidState
+    {
+        PidState();
+
+        std::string codecName;
+        int64_t rxRate;
+        int64_t ebSize;
+
+        double tbFill;
+        double lastTime;
+        std::deque<AccessUnit> accessUnits;
+        int64_t ebFill;
+        int64_t lateBytes;  // bytes of already removed access units which are still arriving
+        bool ebOverflow;
+
+        // current second
+        int64_t secBytes;
+        int64_t secMaxEb;
+        int secUnderflows;
+        int secEbOverflows;
+        int secTbOverflows;
+
+        // whole stream
+        int64_t peakBitrate;
+        int64_t peakEb;
+        int64_t underflows;
+        int64_t ebOverflows;
+        int64_t tbOverflows;
+    };
+
+    struct PendingPacket
+    {
+        int pid;
+        int payloadLen;
+    };
+
+    void processPacket(const PendingPacket& packet, double time);
+    void removeAccessUnits(PidState& state, double time);
+    void flushSecond();
+
+    std::map<int, PidState> m_pids;
+    std::vector<PendingPacket> m_pending;
+    int64_t m_lastPCR;
+    double m_lastTickPerPacket;
+    int64_t m_firstTime;
+    int64_t m_curSecond;
+    int64_t m_secTotalBytes;
+    int64_t m_peakTotalBitrate;
+    std::ostringstream m_report;
+};
+
+#endif
@@ -2,6 +2,7 @@
 
 #include <climits>
 #include <cmath>
+#include <cstring>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -11,6 +12,7 @@
 using namespace std;
 
 bool sLastMsg = false;
+thread_local LogCapture* sLogCapture = nullptr;
 
 std::string toNativeSeparators(const std::string& dirName)
 {
@@ -32,6 +34,21 @@ bool isFillerNullPacket(uint8_t* curBuf)
     return true;
 }
 
+uint8_t* findStartCode(uint8_t* buffer, uint8_t* end)
+{
+    // memchr finds the 01 bytes a vector at a time, they are rare in compressed data
+    for (uint8_t* cur = buffer + 2; cur < end;)
+    {
+        const auto one = static_cast<uint8_t*>(memchr(cur, 1, end - cur));
+        if (!one)
+            break;
+        if (one[-1] == 0 && one[-2] == 0)
+            return one - 2;
+        cur = one + 1;
+    }
+    return end;
+}
+
 std::string unquoteStr(const std::string& val)
 {
     std::string tmp = val;
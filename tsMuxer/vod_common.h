@@ -5,26 +5,39 @@
 
 #include <chrono>
 #include <iostream>
+#include <sstream>
 #include <string>
 #include <thread>
 #include <vector>
 
 #if 1
 extern bool sLastMsg;
-#define LTRACE(level, errIndex, msg)               \
-    do                                             \
-    {                                              \
-        {                                          \
-            if ((errIndex)&2)                      \
-            {                                      \
-                if ((level) <= LT_WARN)            \
-                    std::cerr << msg << std::endl; \
-                else if ((level) == LT_INFO)       \
-                    std::cout << msg << std::endl; \
-                if ((level) <= LT_INFO)            \
-                    sLastMsg = true;               \
-            }                                      \
-        }                                          \
+
+// the messages of a thread go to its log capture while it has one, see METADemuxer::DetectStreamReaders
+struct LogCapture
+{
+    std::ostringstream out;
+    std::ostringstream err;
+};
+extern thread_local LogCapture* sLogCapture;
+
+inline std::ostream& logOut() { return sLogCapture ? sLogCapture->out : std::cout; }
+inline std::ostream& logErr() { return sLogCapture ? sLogCapture->err : std::cerr; }
+
+#define LTRACE(level, errIndex, msg)              \
+    do                                            \
+    {                                             \
+        {                                         \
+            if ((errIndex)&2)                     \
+            {                                     \
+                if ((level) <= LT_WARN)           \
+                    logErr() << msg << std::endl; \
+                else if ((level) == LT_INFO)      \
+                    logOut() << msg << std::endl; \
+                if ((level) <= LT_INFO)           \
+                    sLastMsg = true;              \
+            }                                     \
+        }                                         \
     } while (0)
 
 class Process
@@ -40,6 +53,7 @@ class Process
 #define bswap_32(x) my_ntohl(x)
 
 static constexpr unsigned DETECT_STREAM_BUFFER_SIZE = 1024 * 1024 * 64;
+static constexpr unsigned DETECT_STREAM_STEP_SIZE = 1024 * 1024 * 4;  // first detection step, doubled up to the above
 static constexpr unsigned TS_PID_NULL = 8191;
 static constexpr unsigned TS_PID_PAT = 0;
 static constexpr unsigned TS_PID_PMT = 1;
@@ -76,6 +90,8 @@ static constexpr int INVALID_BITSTREAM_SYNTAX = -11;
 static constexpr int MAX_ERROR = -100;
 
 bool isFillerNullPacket(uint8_t* curBuf);
+// first 00 00 01 start code in the buffer, or end
+uint8_t* findStartCode(uint8_t* buffer, uint8_t* end);
 
 std::string unquoteStr(const std::string& val);
 std::string quoteStr(const std::string& val);
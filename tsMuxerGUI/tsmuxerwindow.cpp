@@ -515,10 +515,22 @@ void TsMuxerWindow::onTsMuxerCodecInfoReceived()
     int lastTrackID = 0;
     QString tmpStr;
     bool firstMark = true;
+    bool probeError = false;
     codecList.clear();
     mplsFileList.clear();
     chapters.clear();
     fileDuration = 0;
+    // a "--probe" run returns the output of several files, keep the others for the next files of the list
+    QString probedFile;
+    for (const QString &line : procStdOutput)
+    {
+        if (line.startsWith("Input file: "))
+            probedFile = line.mid(QString("Input file: ").length());
+        else if (!probedFile.isEmpty())
+            probeCache[probedFile] << line;
+    }
+    if (!probedFile.isEmpty())
+        procStdOutput = probeCache.take(newFileName);
     for (int i = 0; i < procStdOutput.size(); ++i)
     {
         p = procStdOutput[i].indexOf("Track ID:    ");
@@ -595,6 +607,7 @@ void TsMuxerWindow::onTsMuxerCodecInfoReceived()
             msgBox.setIcon(QMessageBox::Warning);
             msgBox.setStandardButtons(QMessageBox::Ok);
             msgBox.exec();
+            probeError = true;
         }
         else if (procStdOutput[i].startsWith("File #"))
         {
@@ -653,6 +666,8 @@ void TsMuxerWindow::onTsMuxerCodecInfoReceived()
     }
 
     m_updateMeta = true;
+    if (probeError)
+        return;
     if (codecList.isEmpty())
     {
         QMessageBox msgBox(this);
@@ -945,6 +960,7 @@ void TsMuxerWindow::addFiles(const QList<QUrl> &files)
 {
     addFileList.clear();
     addFileList = files;
+    probeCache.clear();
     addFile();
 }
 
@@ -1441,7 +1457,8 @@ void TsMuxerWindow::onProcessFinished(int exitCode, QProcess::ExitStatus exitSta
     ui->buttonMux->setEnabled(true);
     ui->addBtn->setEnabled(true);
     inputFilesLVChanged();
-    if (processExitCode == 0)
+    // the "Error:" line of a file which can't be probed is handled with the output of this file
+    if (processExitCode == 0 || (runInProbeMode && exitStatus == QProcess::NormalExit))
         emit tsMuxerSuccessFinished();
 }
 
@@ -1501,6 +1518,15 @@ static QString getTsMuxerBinaryPath()
     return QString();
 }
 
+// track detection results are kept between the runs of tsMuxeR, an empty string if there is no cache directory
+static QString getProbeCacheArg()
+{
+    const auto cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (cacheDir.isEmpty() || !QDir().mkpath(cacheDir))
+        return QString();
+    return QString("--probe-cache=") + QDir::toNativeSeparators(cacheDir + "/probe.cache");
+}
+
 void TsMuxerWindow::tsMuxerExecute(const QStringList &args)
 {
     const auto exePath = getTsMuxerBinaryPath();
@@ -2489,6 +2515,7 @@ void TsMuxerWindow::startMuxing()
     disconnect();
     // QCoreApplication::dir
     runInMuxMode = true;
+    runInProbeMode = false;
     tsMuxerExecute(QStringList() << metaName << quoteStr(ui->outFileName->text()));
 }
 
@@ -2580,6 +2607,7 @@ void TsMuxerWindow::dropEvent(QDropEvent *event)
     }
     if (addFileList.isEmpty())
         return;
+    probeCache.clear();
     auto w = childAt(event->pos());
     if (w && w == ui->btnAppend && w->isEnabled())
         appendFile();
@@ -2824,7 +2852,28 @@ void TsMuxerWindow::processAddFileList(OnCodecListReadyFn onCodecListReady, Post
     connect(this, &TsMuxerWindow::codecListReady, this, onCodecListReady);
     connect(this, postActionSignal, this, postActionFn);
     runInMuxMode = false;
-    tsMuxerExecute(QStringList() << newFileName);
+    runInProbeMode = false;
+    if (probeCache.contains(newFileName))
+    {
+        procStdOutput = probeCache.take(newFileName);
+        QTimer::singleShot(0, this, &TsMuxerWindow::tsMuxerSuccessFinished);
+        return;
+    }
+    probeCache.clear();
+    QStringList args;
+    const auto cacheArg = getProbeCacheArg();
+    if (!cacheArg.isEmpty())
+        args << cacheArg;
+    if (!addFileList.isEmpty())
+    {
+        // detect the rest of the list in the same run, tsMuxeR probes the files in parallel
+        runInProbeMode = true;
+        args << "--probe" << newFileName;
+        for (const auto &url : addFileList) args << QDir::toNativeSeparators(url.toLocalFile());
+    }
+    else
+        args << newFileName;
+    tsMuxerExecute(args);
 }
 
 template <typename F>
@@ -2835,6 +2884,7 @@ void TsMuxerWindow::showAddFilesDialog(QString &&windowTitle, F &&windowOkFn)
         return;
     lastInputDir = QDir::toNativeSeparators(files.back());
     addFileList.clear();
+    probeCache.clear();
     for (auto f : files)
     {
         addFileList << QUrl::fromLocalFile(QDir::toNativeSeparators(f));
@@ -2,6 +2,7 @@
 #define TSMUXER_H_
 
 #include <QHeaderView>
+#include <QMap>
 #include <QProcess>
 #include <QTimer>
 #include <QTranslator>
@@ -181,9 +182,11 @@ class TsMuxerWindow : public QWidget
     ChapterList chapters;
     double fileDuration;
     bool runInMuxMode;
+    bool runInProbeMode;  // a "--probe" run, its output is read even if a file fails: each file has its own status
     QString lastInputDir;
     QString lastOutputDir;
     QList<QUrl> addFileList;
+    QMap<QString, QList<QString>> probeCache;  // tsMuxeR output of the files of addFileList probed ahead
     QTimer opacityTimer;
     bool m_updateMeta;
     bool m_3dMode;